@@ -833,4 +833,1351 @@ static int accesio_write_usb_control(int file_descriptor, uint16_t request, uint
     return ACCESIO_SUCCESS;
 }
 
+/*** STREAMING FUNCTIONS ***/
+
+/**
+ * @brief           Starts interrupt driven streaming of the analog input FIFO
+ *                  on a PCI-AI12-16 family device. Each interrupt the driver
+ *                  drains `samples_per_irq` samples from the card FIFO into a
+ *                  kernel ring buffer which is then read with `accesio_ai_stream_read`.
+ * 
+ * @param   device              A reference to the device opened.
+ * @param   ring_samples        The size of the kernel ring in samples, 0 for the default.
+ * @param   samples_per_irq     The number of samples to drain each interrupt; this
+ *                              should match the FIFO threshold the card is set up for.
+ * @param   irq_enable          The value written to the interrupt control register
+ *                              to re-arm the FIFO interrupt after each drain.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_ai_stream_start(accesio_pci_device* device, uint32_t ring_samples, uint32_t samples_per_irq, uint8_t irq_enable)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    accesio_pci_ai_stream_config config;
+    config.ring_samples = ring_samples;
+    config.samples_per_irq = samples_per_irq;
+    config.irq_enable = irq_enable;
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_AI_STREAM_START, &config) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Stops analog input streaming on the device. Samples still
+ *                  in the kernel ring can be read until it is empty.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_ai_stream_stop(accesio_pci_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_AI_STREAM_STOP) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Retrieves the state and counters of the analog input stream.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   status  A reference where the stream status is stored.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_ai_stream_status(accesio_pci_device* device, accesio_pci_ai_stream_status* status)
+{
+    if (device == NULL || device->file_descriptor == 0 || status == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_AI_STREAM_STATUS, status) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Reads streamed samples from the device. This blocks until
+ *                  at least one sample is available unless the device was
+ *                  opened with O_NONBLOCK.
+ * 
+ * @param   device      A reference to the device opened.
+ * @param   samples     The buffer the samples are read to.
+ * @param   count       The number of samples `samples` can hold.
+ * 
+ * @return  int     On success, the number of samples read is returned (0 once
+ *                  the stream is stopped and drained), on failure, the error
+ *                  code is returned.
+ */
+static int accesio_ai_stream_read(accesio_pci_device* device, uint16_t* samples, uint32_t count)
+{
+    if (device == NULL || device->file_descriptor == 0 || samples == NULL || count == 0) { return -EINVAL; }
+    ssize_t ret = read(device->file_descriptor, samples, (count * sizeof(uint16_t)));
+    if (ret == -1) {
+        return -errno;
+    }
+    return (int)(ret / sizeof(uint16_t));
+}
+
+/**
+ * @brief           Sets up waveform playback on a PCI-DA12 family device. This
+ *                  allocates the two playback buffers and must be done while
+ *                  playback is stopped.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   config  A reference to the playback configuration.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_da_playback_setup(accesio_pci_device* device, accesio_pci_da_playback_config* config)
+{
+    if (device == NULL || device->file_descriptor == 0 || config == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DA_PLAYBACK_SETUP, config) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Queues a buffer of interleaved frames for playback. While
+ *                  playback is running and both buffers are in use, this blocks
+ *                  until one is free unless the device was opened with O_NONBLOCK.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   samples The interleaved samples, `frames * channels` values.
+ * @param   frames  The number of frames in `samples`.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_da_playback_load(accesio_pci_device* device, uint16_t* samples, uint32_t frames)
+{
+    if (device == NULL || device->file_descriptor == 0 || samples == NULL || frames == 0) { return -EINVAL; }
+    accesio_pci_da_playback_buffer buffer;
+    buffer.samples = samples;
+    buffer.frames = frames;
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DA_PLAYBACK_LOAD, &buffer) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Starts waveform playback from the first loaded buffer.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_da_playback_start(accesio_pci_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DA_PLAYBACK_START) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Stops waveform playback, the DACs keep their last value.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_da_playback_stop(accesio_pci_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DA_PLAYBACK_STOP) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Retrieves the state and counters of the waveform playback.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   status  A reference where the playback status is stored.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_da_playback_status(accesio_pci_device* device, accesio_pci_da_playback_status* status)
+{
+    if (device == NULL || device->file_descriptor == 0 || status == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DA_PLAYBACK_STATUS, status) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Sets up the digital output pattern engine of the device. This
+ *                  allocates the step table (or ring when streaming) and must be
+ *                  done while the pattern is stopped.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   config  A reference to the pattern configuration.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_dio_pattern_setup(accesio_pci_device* device, accesio_pci_dio_pattern_config* config)
+{
+    if (device == NULL || device->file_descriptor == 0 || config == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DIO_PATTERN_SETUP, config) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Loads pattern steps. In table mode the steps replace the table;
+ *                  when streaming, as many steps as fit are appended to the ring.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   steps   The steps to load.
+ * @param   count   The number of steps in `steps`.
+ * 
+ * @return  int     On success, the number of steps loaded is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_dio_pattern_load(accesio_pci_device* device, accesio_pci_dio_pattern_step* steps, uint32_t count)
+{
+    if (device == NULL || device->file_descriptor == 0 || steps == NULL || count == 0) { return -EINVAL; }
+    accesio_pci_dio_pattern_steps load;
+    load.steps = steps;
+    load.count = count;
+    int ret = ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DIO_PATTERN_LOAD, &load);
+    if (ret == -1) {
+        return -errno;
+    }
+    return ((ret == 0) ? (int)count : ret);
+}
+
+/**
+ * @brief           Starts the digital output pattern.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_dio_pattern_start(accesio_pci_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DIO_PATTERN_START) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Stops the digital output pattern, the ports keep their last value.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_dio_pattern_stop(accesio_pci_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DIO_PATTERN_STOP) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Retrieves the state and timing statistics of the pattern.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   status  A reference where the pattern status is stored.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_dio_pattern_status(accesio_pci_device* device, accesio_pci_dio_pattern_status* status)
+{
+    if (device == NULL || device->file_descriptor == 0 || status == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DIO_PATTERN_STATUS, status) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Binds devices into a group on this device handle so their
+ *                  registers can be read or written together.
+ * 
+ * @param   device          A reference to the device opened.
+ * @param   device_index    The driver index of each member device.
+ * @param   count           The number of members, 0 to unbind the group.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_group_bind(accesio_pci_device* device, const uint32_t* device_index, uint32_t count)
+{
+    if (device == NULL || device->file_descriptor == 0 || count > ACCESIO_PCI_GROUP_MAX) { return -EINVAL; }
+    if (device_index == NULL && count != 0) { return -EINVAL; }
+    accesio_pci_group_config config;
+    uint32_t i = 0;
+    config.count = count;
+    for (i = 0; i < count; ++i) { config.device_index[i] = device_index[i]; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_GROUP_BIND, &config) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Reads the registers listed in the transfer across the bound
+ *                  group in one pass with interrupts disabled.
+ * 
+ * @param   device      A reference to the device opened.
+ * @param   transfer    A reference to the transfer; the entries receive the values
+ *                      read and the transfer receives the timestamp and span.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_group_read(accesio_pci_device* device, accesio_pci_group_transfer* transfer)
+{
+    if (device == NULL || device->file_descriptor == 0 || transfer == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_GROUP_READ, transfer) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Writes the registers listed in the transfer across the bound
+ *                  group in one pass with interrupts disabled.
+ * 
+ * @param   device      A reference to the device opened.
+ * @param   transfer    A reference to the transfer; it receives the timestamp and span.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_group_write(accesio_pci_device* device, accesio_pci_group_transfer* transfer)
+{
+    if (device == NULL || device->file_descriptor == 0 || transfer == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_GROUP_WRITE, transfer) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Starts kernel servicing of a PCI-WDG family watchdog. The
+ *                  driver refreshes the watchdog from a timer for as long as
+ *                  `accesio_wdg_heartbeat` is called within the liveness window.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   config  A reference to the servicing configuration.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_wdg_service_start(accesio_pci_device* device, accesio_pci_wdg_service_config* config)
+{
+    if (device == NULL || device->file_descriptor == 0 || config == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_WDG_SERVICE_START, config) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Stops kernel servicing of the watchdog.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_wdg_service_stop(accesio_pci_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_WDG_SERVICE_STOP) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Tells the driver the application is alive, keeping the
+ *                  watchdog refreshes going for another liveness window.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_wdg_heartbeat(accesio_pci_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_WDG_HEARTBEAT) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Retrieves the state and margin statistics of the watchdog servicing.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   status  A reference where the servicing status is stored.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_wdg_service_status(accesio_pci_device* device, accesio_pci_wdg_service_status* status)
+{
+    if (device == NULL || device->file_descriptor == 0 || status == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_WDG_SERVICE_STATUS, status) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Starts the input debounce filter on a PCI-IIRO or PCI-IDIO
+ *                  device. While it runs, only debounced input changes wake
+ *                  `accesio_wait_for_irq` and are queued as events.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   config  A reference to the filter configuration.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_debounce_start(accesio_pci_device* device, accesio_pci_debounce_config* config)
+{
+    if (device == NULL || device->file_descriptor == 0 || config == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DEBOUNCE_START, config) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Stops the input debounce filter.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_debounce_stop(accesio_pci_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DEBOUNCE_STOP) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Reads queued debounce events without blocking.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   events  The buffer the events are read into.
+ * @param   count   The number of events `events` can hold.
+ * 
+ * @return  int     On success, the number of events read is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_debounce_events(accesio_pci_device* device, accesio_pci_debounce_event* events, uint32_t count)
+{
+    if (device == NULL || device->file_descriptor == 0 || events == NULL || count == 0) { return -EINVAL; }
+    accesio_pci_debounce_events request;
+    request.events = events;
+    request.count = count;
+    int ret = ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DEBOUNCE_EVENTS, &request);
+    if (ret == -1) {
+        return -errno;
+    }
+    return ret;
+}
+
+/**
+ * @brief           Retrieves the debounced port values and filter counters.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   status  A reference where the filter status is stored.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_debounce_status(accesio_pci_device* device, accesio_pci_debounce_status* status)
+{
+    if (device == NULL || device->file_descriptor == 0 || status == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_DEBOUNCE_STATUS, status) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Latches the selected 8254 counters and reads them.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   capture A reference to the counters to capture, the
+ *                  captured values are stored in `capture->sample`.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_counter_capture(accesio_pci_device* device, accesio_pci_counter_capture* capture)
+{
+    if (device == NULL || device->file_descriptor == 0 || capture == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_COUNTER_CAPTURE, capture) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Starts capturing the selected 8254 counters periodically.
+ * 
+ * @param   device      A reference to the device opened.
+ * @param   periodic    A reference to the capture configuration.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_counter_periodic_start(accesio_pci_device* device, accesio_pci_counter_periodic* periodic)
+{
+    if (device == NULL || device->file_descriptor == 0 || periodic == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_COUNTER_PERIODIC_START, periodic) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Stops periodic counter captures.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_counter_periodic_stop(accesio_pci_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_COUNTER_PERIODIC_STOP) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Reads queued periodic captures without blocking.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   samples The buffer the captures are read into.
+ * @param   count   The number of captures `samples` can hold.
+ * @param   dropped A reference where the number of captures lost is
+ *                  stored, may be NULL.
+ * 
+ * @return  int     On success, the number of captures read is returned,
+ *                  on failure, the error code is returned.
+ */
+static int accesio_counter_read(accesio_pci_device* device, accesio_pci_counter_sample* samples, uint32_t count, uint64_t* dropped)
+{
+    if (device == NULL || device->file_descriptor == 0 || samples == NULL || count == 0) { return -EINVAL; }
+    accesio_pci_counter_samples request;
+    request.samples = samples;
+    request.count = count;
+    request.dropped = 0;
+    int ret = ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_COUNTER_READ, &request);
+    if (ret == -1) {
+        return -errno;
+    }
+    if (dropped != NULL) { *dropped = request.dropped; }
+    return ret;
+}
+
+/**
+ * @brief           Runs a bit-banged SPI or shift register transfer in the
+ *                  driver.
+ * 
+ * @param   device      A reference to the device opened.
+ * @param   transfer    A reference to the lines, mode and buffers of
+ *                      the transfer.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_bitbang_transfer(accesio_pci_device* device, accesio_pci_bitbang_transfer* transfer)
+{
+    if (device == NULL || device->file_descriptor == 0 || transfer == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_BITBANG_TRANSFER, transfer) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Starts decoding quadrature encoders on digital inputs,
+ *                  the counters restart from 0.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   config  A reference to the encoder lines and sample period.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_quadrature_start(accesio_pci_device* device, accesio_pci_quadrature_config* config)
+{
+    if (device == NULL || device->file_descriptor == 0 || config == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_QUADRATURE_START, config) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Stops the quadrature decoder.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_quadrature_stop(accesio_pci_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_QUADRATURE_STOP) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Retrieves the position and error counters of every
+ *                  encoder at once.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   counts  A reference where the counters are stored.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_quadrature_counts(accesio_pci_device* device, accesio_pci_quadrature_counts* counts)
+{
+    if (device == NULL || device->file_descriptor == 0 || counts == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_QUADRATURE_COUNTS, counts) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Queues register writes to execute at given times.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   writes  The writes to queue.
+ * @param   count   The number of writes in `writes`.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_timed_write_queue(accesio_pci_device* device, accesio_pci_timed_write* writes, uint32_t count)
+{
+    if (device == NULL || device->file_descriptor == 0 || writes == NULL || count == 0) { return -EINVAL; }
+    accesio_pci_timed_writes request;
+    request.entries = writes;
+    request.count = count;
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_TIMED_WRITE_QUEUE, &request) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Cancels the pending writes with a tag.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   tag     The tag of the writes, ACCESIO_PCI_TIMED_WRITE_ALL
+ *                  cancels every pending write.
+ * 
+ * @return  int     On success, the number of writes cancelled is
+ *                  returned, on failure, the error code is returned.
+ */
+static int accesio_timed_write_cancel(accesio_pci_device* device, uint32_t tag)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    int ret = ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_TIMED_WRITE_CANCEL, &tag);
+    if (ret == -1) {
+        return -errno;
+    }
+    return ret;
+}
+
+/**
+ * @brief           Copies the pending writes, earliest deadline first.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   writes  The buffer the pending writes are copied into, may
+ *                  be NULL when `count` is 0.
+ * @param   count   The number of writes `writes` can hold.
+ * 
+ * @return  int     On success, the total number of pending writes is
+ *                  returned, on failure, the error code is returned.
+ */
+static int accesio_timed_write_pending(accesio_pci_device* device, accesio_pci_timed_write* writes, uint32_t count)
+{
+    if (device == NULL || device->file_descriptor == 0 || (writes == NULL && count != 0)) { return -EINVAL; }
+    accesio_pci_timed_writes request;
+    request.entries = writes;
+    request.count = count;
+    int ret = ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_TIMED_WRITE_PENDING, &request);
+    if (ret == -1) {
+        return -errno;
+    }
+    return ret;
+}
+
+/**
+ * @brief           Reads the completions of executed writes without
+ *                  blocking.
+ * 
+ * @param   device      A reference to the device opened.
+ * @param   completions The buffer the completions are read into.
+ * @param   count       The number of completions `completions` can hold.
+ * @param   dropped     A reference where the number of completions lost
+ *                      is stored, may be NULL.
+ * 
+ * @return  int     On success, the number of completions read is
+ *                  returned, on failure, the error code is returned.
+ */
+static int accesio_timed_write_completions(accesio_pci_device* device, accesio_pci_timed_completion* completions, uint32_t count, uint64_t* dropped)
+{
+    if (device == NULL || device->file_descriptor == 0 || completions == NULL || count == 0) { return -EINVAL; }
+    accesio_pci_timed_completions request;
+    request.completions = completions;
+    request.count = count;
+    request.dropped = 0;
+    int ret = ioctl(device->file_descriptor, ACCESIO_IOCTL_PCI_TIMED_WRITE_COMPLETIONS, &request);
+    if (ret == -1) {
+        return -errno;
+    }
+    if (dropped != NULL) { *dropped = request.dropped; }
+    return ret;
+}
+
+/**
+ * @brief           Retrieves the usage of the buffers synchronous USB
+ *                  transfers are copied through.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   stats   A reference where the buffer usage is stored.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_get_bounce_stats(accesio_usb_device* device, accesio_usb_bounce_stats* stats)
+{
+    if (device == NULL || device->file_descriptor == 0 || stats == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_BOUNCE_STATS, stats) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Reads from the bulk endpoint in a single transfer of
+ *                  up to ACCESIO_USB_ZEROCOPY_MAX bytes.
+ * 
+ * @param   device          A reference to the device opened.
+ * @param   data            The buffer the data read is stored in.
+ * @param   length          The number of bytes to read.
+ * @param   timeout_ms      The time the transfer may take in milliseconds,
+ *                          0 selects the default.
+ * @param   actual_length   A reference where the number of bytes read is
+ *                          stored, may be NULL.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_read_usb_bulk(accesio_usb_device* device, void* data, uint32_t length, uint32_t timeout_ms, uint32_t* actual_length)
+{
+    if (device == NULL || device->file_descriptor == 0 || data == NULL || length == 0) { return -EINVAL; }
+    accesio_usb_bulk_transfer transfer;
+    transfer.data = data;
+    transfer.length = length;
+    transfer.actual_length = 0;
+    transfer.timeout_ms = timeout_ms;
+    transfer.direction = ACCESIO_USB_DIR_IN;
+    int ret = ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_BULK_TRANSFER, &transfer);
+    if (actual_length != NULL) { *actual_length = transfer.actual_length; }
+    if (ret == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Writes to the bulk endpoint in a single transfer of
+ *                  up to ACCESIO_USB_ZEROCOPY_MAX bytes.
+ * 
+ * @param   device          A reference to the device opened.
+ * @param   data            The data to write.
+ * @param   length          The number of bytes to write.
+ * @param   timeout_ms      The time the transfer may take in milliseconds,
+ *                          0 selects the default.
+ * @param   actual_length   A reference where the number of bytes written
+ *                          is stored, may be NULL.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_write_usb_bulk(accesio_usb_device* device, const void* data, uint32_t length, uint32_t timeout_ms, uint32_t* actual_length)
+{
+    if (device == NULL || device->file_descriptor == 0 || data == NULL || length == 0) { return -EINVAL; }
+    accesio_usb_bulk_transfer transfer;
+    transfer.data = (void*)data;
+    transfer.length = length;
+    transfer.actual_length = 0;
+    transfer.timeout_ms = timeout_ms;
+    transfer.direction = ACCESIO_USB_DIR_OUT;
+    int ret = ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_BULK_TRANSFER, &transfer);
+    if (actual_length != NULL) { *actual_length = transfer.actual_length; }
+    if (ret == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Submits a bulk or vendor control transfer without
+ *                  waiting for it to complete.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   request A reference to the transfer, `request->tag` is set
+ *                  to the tag of the transfer.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_async_submit(accesio_usb_device* device, accesio_usb_async_request* request)
+{
+    if (device == NULL || device->file_descriptor == 0 || request == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_ASYNC_SUBMIT, request) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Retrieves the oldest completed asynchronous transfer.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   request A reference where the completed transfer is stored.
+ * @param   block   Wait for a transfer to complete if none has.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_async_reap(accesio_usb_device* device, accesio_usb_async_request* request, bool block)
+{
+    if (device == NULL || device->file_descriptor == 0 || request == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, (block ? ACCESIO_IOCTL_USB_ASYNC_REAP : ACCESIO_IOCTL_USB_ASYNC_REAP_NONBLOCK), request) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Cancels an asynchronous transfer still in flight.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   tag     The tag returned when the transfer was submitted.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_async_discard(accesio_usb_device* device, uint64_t tag)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_ASYNC_DISCARD, &tag) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Starts streaming the bulk-in endpoint into the driver's
+ *                  ring, which `read()` then drains.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   config  A reference to the URB count and size and the ring
+ *                  size, may be NULL for the defaults.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_stream_in_start(accesio_usb_device* device, accesio_usb_stream_config* config)
+{
+    accesio_usb_stream_config defaults = { 0, 0, 0, 0 };
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_STREAM_IN_START, (config ? config : &defaults)) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Stops the bulk-in stream, the data still in the ring
+ *                  can be read.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_stream_in_stop(accesio_usb_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_STREAM_IN_STOP) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Retrieves the state and counters of the bulk-in stream.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   status  A reference where the status is stored.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_stream_in_status(accesio_usb_device* device, accesio_usb_stream_status* status)
+{
+    if (device == NULL || device->file_descriptor == 0 || status == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_STREAM_IN_STATUS, status) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Starts streaming the driver's ring out of the bulk-out
+ *                  endpoint, `write()` then fills the ring.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   config  A reference to the URB count and size, the ring size
+ *                  and the low-water mark, may be NULL for the defaults.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_stream_out_start(accesio_usb_device* device, accesio_usb_stream_config* config)
+{
+    accesio_usb_stream_config defaults = { 0, 0, 0, 0 };
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_STREAM_OUT_START, (config ? config : &defaults)) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Stops the bulk-out stream, data still in the ring is
+ *                  dropped.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_stream_out_stop(accesio_usb_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_STREAM_OUT_STOP) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Retrieves the state and counters of the bulk-out stream.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   status  A reference where the status is stored.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_stream_out_status(accesio_usb_device* device, accesio_usb_stream_status* status)
+{
+    if (device == NULL || device->file_descriptor == 0 || status == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_STREAM_OUT_STATUS, status) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Sets the number of URBs preallocated for `write()`,
+ *                  which is the most writes in flight.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   depth   The number of URBs, 1 to ACCESIO_USB_WRITE_POOL_MAX.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_write_pool_resize(accesio_usb_device* device, uint32_t depth)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_WRITE_POOL_RESIZE, &depth) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Retrieves the use of the URBs preallocated for `write()`.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   stats   A reference where the statistics are stored.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_write_pool_stats_get(accesio_usb_device* device, accesio_usb_write_pool_stats* stats)
+{
+    if (device == NULL || device->file_descriptor == 0 || stats == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_WRITE_POOL_STATS, stats) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Maps the bulk-in stream's control page and ring, so
+ *                  the samples are read where the driver stores them.
+ * 
+ * @param   device  A reference to the device opened, with the stream
+ *                  started.
+ * @param   control A reference where the address of the control page is
+ *                  stored, the ring follows it at `data_offset`.
+ * @param   length  A reference where the length of the mapping is stored,
+ *                  for `munmap`.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_stream_in_map(accesio_usb_device* device, accesio_usb_stream_control** control, size_t* length)
+{
+    void* address = NULL;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    accesio_usb_stream_status status;
+    if (device == NULL || device->file_descriptor == 0 || control == NULL || length == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_STREAM_IN_STATUS, &status) == -1) {
+        return -errno;
+    }
+    *length = page + ((status.ring_size + page - 1) & ~(page - 1));
+    address = mmap(NULL, *length, (PROT_READ | PROT_WRITE), MAP_SHARED, device->file_descriptor, 0);
+    if (address == MAP_FAILED) {
+        return -errno;
+    }
+    *control = (accesio_usb_stream_control*)address;
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Starts listening on the interrupt-IN endpoint, every
+ *                  report is queued with the time it arrived.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_interrupt_start(accesio_usb_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_INTERRUPT_START) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Stops listening on the interrupt-IN endpoint, the
+ *                  queued reports can still be read.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_interrupt_stop(accesio_usb_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_INTERRUPT_STOP) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Reads the queued interrupt-IN reports without waiting.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   reports A reference to the buffer and its size, the error that
+ *                  stopped the listener and the drop count are set.
+ * 
+ * @return  int     On success, the number of reports read is returned,
+ *                  on failure, the error code is returned.
+ */
+static int accesio_usb_interrupt_read(accesio_usb_device* device, accesio_usb_interrupt_reports* reports)
+{
+    int ret = 0;
+    if (device == NULL || device->file_descriptor == 0 || reports == NULL) { return -EINVAL; }
+    ret = ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_INTERRUPT_READ, reports);
+    return (ret == -1) ? -errno : ret;
+}
+
+/**
+ * @brief           Starts streaming the isochronous-in endpoint, selecting
+ *                  the alternate setting that carries it.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   config  A reference to the URB count and size and the ring
+ *                  size, may be NULL for the defaults.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_iso_start(accesio_usb_device* device, accesio_usb_stream_config* config)
+{
+    accesio_usb_stream_config defaults = { 0, 0, 0, 0 };
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_ISO_START, (config ? config : &defaults)) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Stops the isochronous stream and returns to alternate
+ *                  setting 0, the packets still in the ring can be read.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_iso_stop(accesio_usb_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_ISO_STOP) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Retrieves the state and counters of the isochronous
+ *                  stream.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   status  A reference where the status is stored.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_iso_status(accesio_usb_device* device, accesio_usb_stream_status* status)
+{
+    if (device == NULL || device->file_descriptor == 0 || status == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_ISO_STATUS, status) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Reads whole packet records from the isochronous stream
+ *                  without waiting.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   packets A reference to the buffer and its size, the bytes and
+ *                  packets read are set.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_iso_read(accesio_usb_device* device, accesio_usb_iso_packets* packets)
+{
+    if (device == NULL || device->file_descriptor == 0 || packets == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_ISO_READ, packets) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Runs vendor control transfers back to back with one
+ *                  call, in order.
+ * 
+ * @param   device      A reference to the device opened.
+ * @param   transfers   The transfers, each one's status is set to the
+ *                      bytes transferred or the error it failed with.
+ * @param   count       The number of transfers, at most
+ *                      ACCESIO_USB_CONTROL_BATCH_MAX.
+ * @param   stop_on_error   Whether the transfers after a failed one are
+ *                          skipped.
+ * 
+ * @return  int     On success, the number of transfers done is returned,
+ *                  on failure, the error code is returned.
+ */
+static int accesio_usb_control_batch_run(accesio_usb_device* device, accesio_usb_control_transfer* transfers, uint32_t count, bool stop_on_error)
+{
+    int ret = 0;
+    accesio_usb_control_batch batch;
+    if (device == NULL || device->file_descriptor == 0 || transfers == NULL) { return -EINVAL; }
+    batch.transfers = transfers;
+    batch.count = count;
+    batch.stop_on_error = (stop_on_error ? 1 : 0);
+    ret = ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_CONTROL_BATCH, &batch);
+    return (ret == -1) ? -errno : ret;
+}
+
+/**
+ * @brief           Merges `write()` calls smaller than size bytes into
+ *                  shared transfers.
+ * 
+ * @param   device      A reference to the device opened.
+ * @param   size        The transfer size merged up to, 0 turns merging off.
+ * @param   delay_us    The most microseconds merged data waits, 0 for the
+ *                      default.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_write_coalesce_set(accesio_usb_device* device, uint32_t size, uint32_t delay_us)
+{
+    accesio_usb_write_coalesce config;
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    config.size = size;
+    config.delay_us = delay_us;
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_WRITE_COALESCE, &config) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Sends the data merged so far and waits until every
+ *                  `write()` transfer has completed.
+ * 
+ * @param   device  A reference to the device opened.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_write_flush(accesio_usb_device* device)
+{
+    if (device == NULL || device->file_descriptor == 0) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_WRITE_FLUSH) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Reads the queued completion timestamps of the bulk-in
+ *                  stream without waiting.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   stamps  A reference to the buffer and its size, the drop count
+ *                  is set.
+ * 
+ * @return  int     On success, the number of timestamps read is returned,
+ *                  on failure, the error code is returned.
+ */
+static int accesio_usb_stream_in_timestamps(accesio_usb_device* device, accesio_usb_stream_timestamps* stamps)
+{
+    int ret = 0;
+    if (device == NULL || device->file_descriptor == 0 || stamps == NULL) { return -EINVAL; }
+    ret = ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_STREAM_IN_TIMESTAMPS, stamps);
+    return (ret == -1) ? -errno : ret;
+}
+
+/**
+ * @brief           Retrieves the estimate of the device's data rate and
+ *                  its offset against CLOCK_MONOTONIC for a stream.
+ * 
+ * @param   device  A reference to the device opened.
+ * @param   clock   A reference to the estimate, `stream` selects the
+ *                  stream.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_stream_clock_get(accesio_usb_device* device, accesio_usb_stream_clock* clock)
+{
+    if (device == NULL || device->file_descriptor == 0 || clock == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_STREAM_CLOCK, clock) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/**
+ * @brief           Converts a stream offset to a CLOCK_MONOTONIC time with
+ *                  a clock estimate.
+ * 
+ * @param   clock   A reference to the estimate.
+ * @param   offset  The stream offset, in bytes.
+ * 
+ * @return  int64_t The time in nanoseconds.
+ */
+static int64_t accesio_usb_stream_clock_time(const accesio_usb_stream_clock* clock, uint64_t offset)
+{
+    int64_t bytes = (int64_t)(offset - clock->ref_offset);
+    // the fraction in double, 32-bit targets have no 128-bit integers
+    return (int64_t)clock->ref_ns + (bytes * (int64_t)(clock->ns_per_byte_q32 >> 32)) +
+           (int64_t)(((double)bytes * (double)(clock->ns_per_byte_q32 & 0xFFFFFFFFULL)) / 4294967296.0);
+}
+
+/**
+ * @brief           Retrieves the CLOCK_MONOTONIC time the last bulk-in
+ *                  transfer of `read()` completed.
+ * 
+ * @param   device          A reference to the device opened.
+ * @param   timestamp_ns    A reference where the time is stored, in
+ *                          nanoseconds.
+ * 
+ * @return  int     On success, ACCESIO_SUCCESS is returned, on
+ *                  failure, the error code is returned.
+ */
+static int accesio_usb_read_timestamp(accesio_usb_device* device, uint64_t* timestamp_ns)
+{
+    if (device == NULL || device->file_descriptor == 0 || timestamp_ns == NULL) { return -EINVAL; }
+    if (ioctl(device->file_descriptor, ACCESIO_IOCTL_USB_READ_TIMESTAMP, timestamp_ns) == -1) {
+        return -errno;
+    }
+    return ACCESIO_SUCCESS;
+}
+
 #endif // ACCESIO_API_H
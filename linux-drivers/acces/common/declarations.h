@@ -39,6 +39,74 @@
     #define ACCESIO_PCI_MAX_CARDS (ACCESIO_PCI_CHANNELS * ACCESIO_PCI_CARDS)
 #endif
 
+#define ACCESIO_PCI_AI_STREAM_RING_DEFAULT 65536
+#define ACCESIO_PCI_AI_STREAM_RING_MAX (1 << 20) // 16-bit samples, the ring is kmalloc'd
+#define ACCESIO_PCI_AI_STREAM_DRAIN_MAX 2048
+
+#define ACCESIO_PCI_DA_PLAYBACK_CHANNELS_MAX 16
+#define ACCESIO_PCI_DA_PLAYBACK_SAMPLES_MAX (1 << 20)
+#define ACCESIO_PCI_DA_PLAYBACK_PERIOD_MIN 10000
+
+#define ACCESIO_PCI_DIO_PATTERN_STEPS_MAX 65536
+#define ACCESIO_PCI_DIO_PATTERN_LATE_DEFAULT 10000
+#define ACCESIO_PCI_DIO_PATTERN_BURST_MAX 64
+
+#define ACCESIO_PCI_GROUP_MAX 8
+#define ACCESIO_PCI_GROUP_IO_MAX 256
+
+#define ACCESIO_PCI_WDG_SERVICE_PERIOD_MIN 100000
+
+#define ACCESIO_PCI_DEBOUNCE_PORTS 4
+#define ACCESIO_PCI_DEBOUNCE_SAMPLE_MIN 20000
+#define ACCESIO_PCI_DEBOUNCE_EVENTS_DEFAULT 256
+#define ACCESIO_PCI_DEBOUNCE_EVENTS_MAX 65536
+
+#define ACCESIO_PCI_COUNTER_CHIPS 4
+#define ACCESIO_PCI_COUNTER_PERIOD_MIN 10000
+#define ACCESIO_PCI_COUNTER_QUEUE_DEFAULT 1024
+#define ACCESIO_PCI_COUNTER_QUEUE_MAX 65536
+
+#define ACCESIO_PCI_BITBANG_MAX 4096
+#define ACCESIO_PCI_BITBANG_HALF_PERIOD_MAX 100000
+#define ACCESIO_PCI_BITBANG_LSB_FIRST 0x01 // shift the least significant bit first
+#define ACCESIO_PCI_BITBANG_CS 0x02 // drive the chip select line around the transfer
+#define ACCESIO_PCI_BITBANG_CS_HIGH 0x04 // chip select is active high
+
+#define ACCESIO_PCI_QUADRATURE_CHANNELS 8
+#define ACCESIO_PCI_QUADRATURE_PERIOD_MIN 5000
+
+#define ACCESIO_PCI_TIMED_WRITE_MAX 256
+#define ACCESIO_PCI_TIMED_WRITE_COMPLETIONS 1024
+#define ACCESIO_PCI_TIMED_WRITE_ALL 0xFFFFFFFF // cancels every pending write
+
+#define ACCESIO_USB_ZEROCOPY_MIN 16384 // smaller bulk transfers are copied
+#define ACCESIO_USB_ZEROCOPY_MAX (8 * 1024 * 1024)
+#define ACCESIO_USB_TIMEOUT_DEFAULT 5000
+
+#define ACCESIO_USB_ASYNC_MAX 64 // transfers in flight per device
+#define ACCESIO_USB_ASYNC_LENGTH_MAX 65536
+
+#define ACCESIO_USB_STREAM_URBS_MAX 32
+#define ACCESIO_USB_STREAM_URBS_DEFAULT 8
+#define ACCESIO_USB_STREAM_URB_SIZE_MAX (256 * 1024)
+#define ACCESIO_USB_STREAM_URB_SIZE_DEFAULT 16384
+#define ACCESIO_USB_STREAM_RING_MAX (64 * 1024 * 1024)
+
+#define ACCESIO_USB_WRITE_POOL_MAX 64 // write() URBs per device
+#define ACCESIO_USB_COALESCE_DELAY_DEFAULT 1000 // microseconds
+#define ACCESIO_USB_COALESCE_DELAY_MAX 1000000
+
+#define ACCESIO_USB_INTERRUPT_REPORT_MAX 64 // bytes kept of each report
+#define ACCESIO_USB_INTERRUPT_QUEUE 256     // reports queued, power of two
+
+#define ACCESIO_USB_CONTROL_BATCH_MAX 256 // transfers per batch
+
+#define ACCESIO_USB_STREAM_STAMPS 1024  // bulk-in completion timestamps queued, power of two
+#define ACCESIO_USB_CLOCK_POINTS 64     // completions the clock estimate spans
+
+#define ACCESIO_USB_ISO_PACKETS_MAX 64    // packets per isochronous URB
+#define ACCESIO_USB_ISO_PACKETS_DEFAULT 8 // when urb_size is 0
+
 #define ACCES_FILE_OP_FLAG_SET(v, f) (((v) & (f)) == (f))
 
 #endif // ACCESIO_COMMON_DEC_H
\ No newline at end of file
@@ -48,6 +48,42 @@
 #define ACCESIO_IOCTL_GET_DEVICE_PLX_END            _IOR(ACCESIO_MAGIC_NUM, 12, uint32_t)
 #define ACCESIO_IOCTL_PCI_WRITE                     _IOW(ACCESIO_MAGIC_NUM, 17, accesio_pci_ioctl_packet*)
 #define ACCESIO_IOCTL_PCI_READ                      _IOR(ACCESIO_MAGIC_NUM, 18, accesio_pci_ioctl_packet*)
+#define ACCESIO_IOCTL_PCI_AI_STREAM_START           _IOW(ACCESIO_MAGIC_NUM, 24, accesio_pci_ai_stream_config*)
+#define ACCESIO_IOCTL_PCI_AI_STREAM_STOP            _IO(ACCESIO_MAGIC_NUM, 25)
+#define ACCESIO_IOCTL_PCI_AI_STREAM_STATUS          _IOR(ACCESIO_MAGIC_NUM, 26, accesio_pci_ai_stream_status*)
+#define ACCESIO_IOCTL_PCI_DA_PLAYBACK_SETUP         _IOW(ACCESIO_MAGIC_NUM, 27, accesio_pci_da_playback_config*)
+#define ACCESIO_IOCTL_PCI_DA_PLAYBACK_LOAD          _IOW(ACCESIO_MAGIC_NUM, 28, accesio_pci_da_playback_buffer*)
+#define ACCESIO_IOCTL_PCI_DA_PLAYBACK_START         _IO(ACCESIO_MAGIC_NUM, 29)
+#define ACCESIO_IOCTL_PCI_DA_PLAYBACK_STOP          _IO(ACCESIO_MAGIC_NUM, 30)
+#define ACCESIO_IOCTL_PCI_DA_PLAYBACK_STATUS        _IOR(ACCESIO_MAGIC_NUM, 31, accesio_pci_da_playback_status*)
+#define ACCESIO_IOCTL_PCI_DIO_PATTERN_SETUP         _IOW(ACCESIO_MAGIC_NUM, 32, accesio_pci_dio_pattern_config*)
+#define ACCESIO_IOCTL_PCI_DIO_PATTERN_LOAD          _IOW(ACCESIO_MAGIC_NUM, 33, accesio_pci_dio_pattern_steps*)
+#define ACCESIO_IOCTL_PCI_DIO_PATTERN_START         _IO(ACCESIO_MAGIC_NUM, 34)
+#define ACCESIO_IOCTL_PCI_DIO_PATTERN_STOP          _IO(ACCESIO_MAGIC_NUM, 35)
+#define ACCESIO_IOCTL_PCI_DIO_PATTERN_STATUS        _IOR(ACCESIO_MAGIC_NUM, 36, accesio_pci_dio_pattern_status*)
+#define ACCESIO_IOCTL_PCI_GROUP_BIND                _IOW(ACCESIO_MAGIC_NUM, 37, accesio_pci_group_config*)
+#define ACCESIO_IOCTL_PCI_GROUP_READ                _IOWR(ACCESIO_MAGIC_NUM, 38, accesio_pci_group_transfer*)
+#define ACCESIO_IOCTL_PCI_GROUP_WRITE               _IOWR(ACCESIO_MAGIC_NUM, 39, accesio_pci_group_transfer*)
+#define ACCESIO_IOCTL_PCI_WDG_SERVICE_START         _IOW(ACCESIO_MAGIC_NUM, 40, accesio_pci_wdg_service_config*)
+#define ACCESIO_IOCTL_PCI_WDG_SERVICE_STOP          _IO(ACCESIO_MAGIC_NUM, 41)
+#define ACCESIO_IOCTL_PCI_WDG_HEARTBEAT             _IO(ACCESIO_MAGIC_NUM, 42)
+#define ACCESIO_IOCTL_PCI_WDG_SERVICE_STATUS        _IOR(ACCESIO_MAGIC_NUM, 43, accesio_pci_wdg_service_status*)
+#define ACCESIO_IOCTL_PCI_DEBOUNCE_START            _IOW(ACCESIO_MAGIC_NUM, 44, accesio_pci_debounce_config*)
+#define ACCESIO_IOCTL_PCI_DEBOUNCE_STOP             _IO(ACCESIO_MAGIC_NUM, 45)
+#define ACCESIO_IOCTL_PCI_DEBOUNCE_EVENTS           _IOWR(ACCESIO_MAGIC_NUM, 46, accesio_pci_debounce_events*)
+#define ACCESIO_IOCTL_PCI_DEBOUNCE_STATUS           _IOR(ACCESIO_MAGIC_NUM, 47, accesio_pci_debounce_status*)
+#define ACCESIO_IOCTL_PCI_COUNTER_CAPTURE           _IOWR(ACCESIO_MAGIC_NUM, 48, accesio_pci_counter_capture*)
+#define ACCESIO_IOCTL_PCI_COUNTER_PERIODIC_START    _IOW(ACCESIO_MAGIC_NUM, 49, accesio_pci_counter_periodic*)
+#define ACCESIO_IOCTL_PCI_COUNTER_PERIODIC_STOP     _IO(ACCESIO_MAGIC_NUM, 50)
+#define ACCESIO_IOCTL_PCI_COUNTER_READ              _IOWR(ACCESIO_MAGIC_NUM, 51, accesio_pci_counter_samples*)
+#define ACCESIO_IOCTL_PCI_BITBANG_TRANSFER          _IOW(ACCESIO_MAGIC_NUM, 52, accesio_pci_bitbang_transfer*)
+#define ACCESIO_IOCTL_PCI_QUADRATURE_START          _IOW(ACCESIO_MAGIC_NUM, 53, accesio_pci_quadrature_config*)
+#define ACCESIO_IOCTL_PCI_QUADRATURE_STOP           _IO(ACCESIO_MAGIC_NUM, 54)
+#define ACCESIO_IOCTL_PCI_QUADRATURE_COUNTS         _IOR(ACCESIO_MAGIC_NUM, 55, accesio_pci_quadrature_counts*)
+#define ACCESIO_IOCTL_PCI_TIMED_WRITE_QUEUE         _IOW(ACCESIO_MAGIC_NUM, 56, accesio_pci_timed_writes*)
+#define ACCESIO_IOCTL_PCI_TIMED_WRITE_CANCEL        _IOW(ACCESIO_MAGIC_NUM, 57, uint32_t*)
+#define ACCESIO_IOCTL_PCI_TIMED_WRITE_PENDING       _IOWR(ACCESIO_MAGIC_NUM, 58, accesio_pci_timed_writes*)
+#define ACCESIO_IOCTL_PCI_TIMED_WRITE_COMPLETIONS   _IOWR(ACCESIO_MAGIC_NUM, 59, accesio_pci_timed_completions*)
 
 // USB-only functions (PCI will return -ENOSYS)
 #define ACCESIO_IOCTL_USB_WRITE                     _IOW(ACCESIO_MAGIC_NUM, 19, accesio_usb_ioctl_packet*)
@@ -55,6 +91,33 @@
 #define ACCESIO_IOCTL_GET_USB_IS_READING            _IOR(ACCESIO_MAGIC_NUM, 21, bool)
 #define ACCESIO_IOCTL_GET_USB_IS_WRITING            _IOR(ACCESIO_MAGIC_NUM, 22, bool)
 #define ACCESIO_IOCTL_GET_USB_IS_IO                 _IOR(ACCESIO_MAGIC_NUM, 23, bool)
+#define ACCESIO_IOCTL_USB_BOUNCE_STATS              _IOR(ACCESIO_MAGIC_NUM, 60, accesio_usb_bounce_stats*)
+#define ACCESIO_IOCTL_USB_BULK_TRANSFER             _IOWR(ACCESIO_MAGIC_NUM, 61, accesio_usb_bulk_transfer*)
+#define ACCESIO_IOCTL_USB_ASYNC_SUBMIT              _IOWR(ACCESIO_MAGIC_NUM, 62, accesio_usb_async_request*)
+#define ACCESIO_IOCTL_USB_ASYNC_REAP                _IOR(ACCESIO_MAGIC_NUM, 63, accesio_usb_async_request*)
+#define ACCESIO_IOCTL_USB_ASYNC_REAP_NONBLOCK       _IOR(ACCESIO_MAGIC_NUM, 64, accesio_usb_async_request*)
+#define ACCESIO_IOCTL_USB_ASYNC_DISCARD             _IOW(ACCESIO_MAGIC_NUM, 65, uint64_t*)
+#define ACCESIO_IOCTL_USB_STREAM_IN_START           _IOW(ACCESIO_MAGIC_NUM, 66, accesio_usb_stream_config*)
+#define ACCESIO_IOCTL_USB_STREAM_IN_STOP            _IO(ACCESIO_MAGIC_NUM, 67)
+#define ACCESIO_IOCTL_USB_STREAM_IN_STATUS          _IOR(ACCESIO_MAGIC_NUM, 68, accesio_usb_stream_status*)
+#define ACCESIO_IOCTL_USB_STREAM_OUT_START          _IOW(ACCESIO_MAGIC_NUM, 69, accesio_usb_stream_config*)
+#define ACCESIO_IOCTL_USB_STREAM_OUT_STOP           _IO(ACCESIO_MAGIC_NUM, 70)
+#define ACCESIO_IOCTL_USB_STREAM_OUT_STATUS         _IOR(ACCESIO_MAGIC_NUM, 71, accesio_usb_stream_status*)
+#define ACCESIO_IOCTL_USB_WRITE_POOL_RESIZE         _IOW(ACCESIO_MAGIC_NUM, 72, uint32_t*)
+#define ACCESIO_IOCTL_USB_WRITE_POOL_STATS          _IOR(ACCESIO_MAGIC_NUM, 73, accesio_usb_write_pool_stats*)
+#define ACCESIO_IOCTL_USB_INTERRUPT_START           _IO(ACCESIO_MAGIC_NUM, 74)
+#define ACCESIO_IOCTL_USB_INTERRUPT_STOP            _IO(ACCESIO_MAGIC_NUM, 75)
+#define ACCESIO_IOCTL_USB_INTERRUPT_READ            _IOWR(ACCESIO_MAGIC_NUM, 76, accesio_usb_interrupt_reports*)
+#define ACCESIO_IOCTL_USB_ISO_START                 _IOW(ACCESIO_MAGIC_NUM, 77, accesio_usb_stream_config*)
+#define ACCESIO_IOCTL_USB_ISO_STOP                  _IO(ACCESIO_MAGIC_NUM, 78)
+#define ACCESIO_IOCTL_USB_ISO_STATUS                _IOR(ACCESIO_MAGIC_NUM, 79, accesio_usb_stream_status*)
+#define ACCESIO_IOCTL_USB_ISO_READ                  _IOWR(ACCESIO_MAGIC_NUM, 80, accesio_usb_iso_packets*)
+#define ACCESIO_IOCTL_USB_CONTROL_BATCH             _IOWR(ACCESIO_MAGIC_NUM, 81, accesio_usb_control_batch*)
+#define ACCESIO_IOCTL_USB_WRITE_COALESCE            _IOW(ACCESIO_MAGIC_NUM, 82, accesio_usb_write_coalesce*)
+#define ACCESIO_IOCTL_USB_WRITE_FLUSH               _IO(ACCESIO_MAGIC_NUM, 83)
+#define ACCESIO_IOCTL_USB_STREAM_IN_TIMESTAMPS      _IOWR(ACCESIO_MAGIC_NUM, 84, accesio_usb_stream_timestamps*)
+#define ACCESIO_IOCTL_USB_STREAM_CLOCK              _IOWR(ACCESIO_MAGIC_NUM, 85, accesio_usb_stream_clock*)
+#define ACCESIO_IOCTL_USB_READ_TIMESTAMP            _IOR(ACCESIO_MAGIC_NUM, 86, uint64_t*)
 
 /**
  * @brief Defines a size type that is used when reading/writing
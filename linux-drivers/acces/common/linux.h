@@ -72,12 +72,44 @@
         #include <linux/usb/serial.h>
         #include <linux/kref.h>
         #include <linux/mutex.h>
+        // streaming includes
+        #include <linux/kfifo.h>
+        #include <linux/poll.h>
+        #include <linux/hrtimer.h>
+        #include <linux/ktime.h>
+        #include <linux/vmalloc.h>
+        #include <linux/mm.h>
+        #include <linux/scatterlist.h>
+        #include <linux/workqueue.h>
+        #include <linux/bitmap.h>
 
         #if LINUX_VERSION_CODE < KERNEL_VERSION(5,0,0)
             #define ACCES_AOK(v,a,s) access_ok(v, a, s)
         #else
             #define ACCES_AOK(v,a,s) access_ok(a, s)
         #endif
+        #if LINUX_VERSION_CODE < KERNEL_VERSION(6,15,0)
+            #define ACCES_HRTIMER_SETUP(t,f,c,m) do { hrtimer_init(t, c, m); (t)->function = f; } while (0)
+        #else
+            #define ACCES_HRTIMER_SETUP(t,f,c,m) hrtimer_setup(t, f, c, m)
+        #endif
+        #if LINUX_VERSION_CODE < KERNEL_VERSION(5,6,0)
+            #define ACCES_PIN_USER_PAGES(a,n,w,p) get_user_pages_fast(a, n, ((w) ? FOLL_WRITE : 0), p)
+            #define ACCES_UNPIN_USER_PAGES(p,n,d) do { long pg_; for (pg_ = 0; pg_ < (long)(n); ++pg_) { if (d) { set_page_dirty_lock((p)[pg_]); } put_page((p)[pg_]); } } while (0)
+        #else
+            #define ACCES_PIN_USER_PAGES(a,n,w,p) pin_user_pages_fast(a, n, ((w) ? FOLL_WRITE : 0), p)
+            #define ACCES_UNPIN_USER_PAGES(p,n,d) unpin_user_pages_dirty_lock(p, n, d)
+        #endif
+        #if LINUX_VERSION_CODE < KERNEL_VERSION(6,3,0)
+            #define ACCES_VM_FLAGS_CLEAR(v,f) ((v)->vm_flags &= ~(f))
+        #else
+            #define ACCES_VM_FLAGS_CLEAR(v,f) vm_flags_clear(v, f)
+        #endif
+        #if LINUX_VERSION_CODE < KERNEL_VERSION(3,15,0)
+            #define ACCES_SG_UNCONSTRAINED(u) false
+        #else
+            #define ACCES_SG_UNCONSTRAINED(u) ((u)->bus->no_sg_constraint)
+        #endif
     //#elif defined(ACCESIO_OS_APPLE)
         
     #else
@@ -93,6 +125,7 @@
     #include <sys/fcntl.h>
     #include <sys/stat.h>
     #include <sys/ioctl.h>
+    #include <sys/mman.h>
     #include <stdio.h>
     #if defined(ACCESIO_OS_LINUX) || defined(ACCESIO_OS_GNU_LINUX) || defined(ACCESIO_OS_ANDROID)
         #include <linux/types.h>
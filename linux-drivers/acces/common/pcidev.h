@@ -122,4 +122,854 @@ typedef struct accesio_pci_info {
     accesio_io_region regions[ACCESIO_MAX_REGIONS];
 } accesio_pci_info;
 
+/**
+ * @brief Describes how the driver streams analog input samples from the
+ *        FIFO of a PCI-AI12-16 family card (PCI-AI12-16/16A, PCI-AIO12-16
+ *        and PCI-A12-16A) into a kernel ring buffer. Once streaming, the
+ *        samples are consumed with `read()` on the device handle.
+ */
+typedef struct accesio_pci_ai_stream_config {
+    /**
+     * @brief The number of 16-bit samples the kernel ring can hold. This
+     *        is rounded up to a power of 2 by the driver; 0 selects
+     *        ACCESIO_PCI_AI_STREAM_RING_DEFAULT.
+     */
+    uint32_t ring_samples;
+    /**
+     * @brief The number of samples drained from the card FIFO on each
+     *        interrupt. This should match the FIFO threshold the card was
+     *        programmed with, and cannot exceed ACCESIO_PCI_AI_STREAM_DRAIN_MAX.
+     */
+    uint32_t samples_per_irq;
+    /**
+     * @brief The value written to the interrupt control register (offset
+     *        0x04) to re-arm the FIFO interrupt after it has been drained.
+     */
+    uint8_t irq_enable;
+} accesio_pci_ai_stream_config;
+
+/**
+ * @brief Describes the state of an analog input stream.
+ */
+typedef struct accesio_pci_ai_stream_status {
+    /**
+     * @brief Non-zero if the stream is running.
+     */
+    uint8_t running;
+    /**
+     * @brief The number of samples waiting in the kernel ring.
+     */
+    uint32_t available;
+    /**
+     * @brief The size of the kernel ring, in samples.
+     */
+    uint32_t ring_samples;
+    /**
+     * @brief The number of FIFO interrupts serviced since the stream started.
+     */
+    uint64_t interrupts;
+    /**
+     * @brief The number of samples drained from the card FIFO.
+     */
+    uint64_t samples;
+    /**
+     * @brief The number of samples dropped because the kernel ring was full.
+     */
+    uint64_t overruns;
+} accesio_pci_ai_stream_status;
+
+/**
+ * @brief Describes a waveform playback on a PCI-DA12 family card. A kernel
+ *        timer writes one frame (one sample per channel) to the DAC registers
+ *        every `period_ns`, from one of two buffers loaded by user code.
+ */
+typedef struct accesio_pci_da_playback_config {
+    /**
+     * @brief The time between frames in nanoseconds, at least
+     *        ACCESIO_PCI_DA_PLAYBACK_PERIOD_MIN.
+     */
+    uint64_t period_ns;
+    /**
+     * @brief The number of channels in a frame, written starting at
+     *        channel 0; at most ACCESIO_PCI_DA_PLAYBACK_CHANNELS_MAX.
+     */
+    uint32_t channels;
+    /**
+     * @brief The largest number of frames a single loaded buffer can hold.
+     *        `channels * frames` cannot exceed ACCESIO_PCI_DA_PLAYBACK_SAMPLES_MAX.
+     */
+    uint32_t frames;
+    /**
+     * @brief The region holding the DAC registers, 0 selects BAR 3.
+     */
+    uint8_t bar;
+    /**
+     * @brief If non-zero, the playing buffer repeats until another buffer
+     *        is loaded; otherwise every buffer is played once and the two
+     *        buffers are used double-buffered.
+     */
+    uint8_t loop;
+    /**
+     * @brief The offset of the channel 0 DAC register within `bar`.
+     */
+    uint16_t offset;
+    /**
+     * @brief The distance between each channels DAC register, 0 selects 2.
+     */
+    uint16_t stride;
+} accesio_pci_da_playback_config;
+
+/**
+ * @brief A buffer of frames queued for playback.
+ */
+typedef struct accesio_pci_da_playback_buffer {
+    /**
+     * @brief The interleaved samples, `frames * channels` 16-bit values.
+     */
+    uint16_t* samples;
+    /**
+     * @brief The number of frames in `samples`.
+     */
+    uint32_t frames;
+} accesio_pci_da_playback_buffer;
+
+/**
+ * @brief Describes the state of a waveform playback.
+ */
+typedef struct accesio_pci_da_playback_status {
+    /**
+     * @brief Non-zero if playback is running.
+     */
+    uint8_t running;
+    /**
+     * @brief The number of loaded buffers waiting or playing (0 to 2).
+     */
+    uint8_t queued;
+    /**
+     * @brief The next frame to be written from the playing buffer.
+     */
+    uint32_t position;
+    /**
+     * @brief The number of frames written to the DACs.
+     */
+    uint64_t frames;
+    /**
+     * @brief The number of buffers played to the end.
+     */
+    uint64_t buffers;
+    /**
+     * @brief The number of frame periods where no buffer was loaded.
+     */
+    uint64_t underruns;
+    /**
+     * @brief The number of frame periods the timer fired too late to service.
+     */
+    uint64_t missed;
+} accesio_pci_da_playback_status;
+
+/**
+ * @brief A single step of a digital output pattern. The bits of `value`
+ *        selected by `mask` are written to the byte register at `offset`,
+ *        then the engine waits `delay_ns` before the next step. Steps with
+ *        a delay of 0 are applied together with the step that follows.
+ */
+typedef struct accesio_pci_dio_pattern_step {
+    /**
+     * @brief The time to wait after this step, in nanoseconds.
+     */
+    uint32_t delay_ns;
+    /**
+     * @brief The register offset (port) the step writes to.
+     */
+    uint16_t offset;
+    /**
+     * @brief The bits of the port changed by this step, 0xFF writes
+     *        the whole port without reading it back first.
+     */
+    uint8_t mask;
+    /**
+     * @brief The value of the bits selected by `mask`.
+     */
+    uint8_t value;
+} accesio_pci_dio_pattern_step;
+
+/**
+ * @brief Describes a digital output pattern run by a kernel timer.
+ */
+typedef struct accesio_pci_dio_pattern_config {
+    /**
+     * @brief The number of steps the table (or streaming ring) can hold,
+     *        at most ACCESIO_PCI_DIO_PATTERN_STEPS_MAX.
+     */
+    uint32_t capacity;
+    /**
+     * @brief The number of times the table is played, 0 to repeat it
+     *        until stopped. Unused when streaming.
+     */
+    uint32_t loops;
+    /**
+     * @brief A step applied later than this many nanoseconds after it was
+     *        due is counted as late, 0 selects ACCESIO_PCI_DIO_PATTERN_LATE_DEFAULT.
+     */
+    uint32_t late_ns;
+    /**
+     * @brief The region the step offsets are in, 0 selects the main BAR.
+     */
+    uint8_t bar;
+    /**
+     * @brief If non-zero, steps are appended to a ring while the pattern
+     *        runs and each is played once, rather than played from a table.
+     */
+    uint8_t streaming;
+} accesio_pci_dio_pattern_config;
+
+/**
+ * @brief A set of steps loaded into the table, or appended to the ring.
+ */
+typedef struct accesio_pci_dio_pattern_steps {
+    /**
+     * @brief The steps to load.
+     */
+    accesio_pci_dio_pattern_step* steps;
+    /**
+     * @brief The number of steps in `steps`.
+     */
+    uint32_t count;
+} accesio_pci_dio_pattern_steps;
+
+/**
+ * @brief Describes the state and timing of a digital output pattern.
+ */
+typedef struct accesio_pci_dio_pattern_status {
+    /**
+     * @brief Non-zero if the pattern is running.
+     */
+    uint8_t running;
+    /**
+     * @brief Non-zero if the pattern is streaming from the ring.
+     */
+    uint8_t streaming;
+    /**
+     * @brief The steps in the table, or the steps queued in the ring.
+     */
+    uint32_t count;
+    /**
+     * @brief The next step to be applied from the table.
+     */
+    uint32_t position;
+    /**
+     * @brief The number of steps applied.
+     */
+    uint64_t steps;
+    /**
+     * @brief The number of times the table was played to the end.
+     */
+    uint64_t loops;
+    /**
+     * @brief The number of times a streaming pattern ran out of steps.
+     */
+    uint64_t underruns;
+    /**
+     * @brief The number of timer expiries applied later than `late_ns`.
+     */
+    uint64_t late;
+    /**
+     * @brief The latest any timer expiry was applied, in nanoseconds.
+     */
+    uint64_t max_late_ns;
+} accesio_pci_dio_pattern_status;
+
+/**
+ * @brief The devices bound into a group so their registers can be read or
+ *        written together in one pass with interrupts disabled.
+ */
+typedef struct accesio_pci_group_config {
+    /**
+     * @brief The number of devices in `device_index`, at most
+     *        ACCESIO_PCI_GROUP_MAX; 0 unbinds the group.
+     */
+    uint32_t count;
+    /**
+     * @brief The driver index (`accesio_pci_info.device_index`) of each
+     *        member. Group entries refer to members by their position here.
+     */
+    uint32_t device_index[ACCESIO_PCI_GROUP_MAX];
+} accesio_pci_group_config;
+
+/**
+ * @brief A single register access of a group transfer.
+ */
+typedef struct accesio_pci_group_io {
+    /**
+     * @brief The value to write, or the value read.
+     */
+    uint32_t data;
+    /**
+     * @brief The register offset within `bar`.
+     */
+    uint16_t offset;
+    /**
+     * @brief The position of the device in the bound group.
+     */
+    uint8_t member;
+    /**
+     * @brief The region of the register, 0 selects the main BAR.
+     */
+    uint8_t bar;
+    /**
+     * @brief The access size: ACCESIO_BYTE, ACCESIO_WORD or ACCESIO_DWORD.
+     */
+    uint8_t size;
+} accesio_pci_group_io;
+
+/**
+ * @brief A set of register accesses across the bound group, run in order
+ *        in one kernel pass.
+ */
+typedef struct accesio_pci_group_transfer {
+    /**
+     * @brief The register accesses.
+     */
+    accesio_pci_group_io* entries;
+    /**
+     * @brief The number of entries, at most ACCESIO_PCI_GROUP_IO_MAX.
+     */
+    uint32_t count;
+    /**
+     * @brief Set by the driver to the CLOCK_MONOTONIC time, in nanoseconds,
+     *        just before the first access.
+     */
+    uint64_t timestamp_ns;
+    /**
+     * @brief Set by the driver to the nanoseconds from the first to the
+     *        last access.
+     */
+    uint64_t span_ns;
+} accesio_pci_group_transfer;
+
+/**
+ * @brief Describes kernel servicing of a PCI-WDG family watchdog. A kernel
+ *        timer performs the refresh (kick) every `period_ns` for as long as
+ *        user code keeps sending heartbeats within `liveness_ns`.
+ */
+typedef struct accesio_pci_wdg_service_config {
+    /**
+     * @brief The time between refreshes in nanoseconds, at least
+     *        ACCESIO_PCI_WDG_SERVICE_PERIOD_MIN.
+     */
+    uint64_t period_ns;
+    /**
+     * @brief The longest time allowed between heartbeats; once exceeded
+     *        the refreshes stop and the watchdog is allowed to expire.
+     */
+    uint64_t liveness_ns;
+    /**
+     * @brief The value written by the refresh, unused if `read` is set.
+     */
+    uint32_t value;
+    /**
+     * @brief The register offset of the refresh.
+     */
+    uint16_t offset;
+    /**
+     * @brief The region of the refresh register, 0 selects the main BAR.
+     */
+    uint8_t bar;
+    /**
+     * @brief The access size: ACCESIO_BYTE, ACCESIO_WORD or ACCESIO_DWORD.
+     */
+    uint8_t size;
+    /**
+     * @brief If non-zero the refresh reads the register instead of writing it.
+     */
+    uint8_t read;
+} accesio_pci_wdg_service_config;
+
+/**
+ * @brief Describes the state and margins of the watchdog servicing.
+ */
+typedef struct accesio_pci_wdg_service_status {
+    /**
+     * @brief Non-zero if the driver is servicing the watchdog.
+     */
+    uint8_t running;
+    /**
+     * @brief Non-zero if refreshes are withheld because the heartbeat
+     *        window was exceeded.
+     */
+    uint8_t withheld;
+    /**
+     * @brief The number of refreshes performed.
+     */
+    uint64_t kicks;
+    /**
+     * @brief The number of heartbeats received.
+     */
+    uint64_t heartbeats;
+    /**
+     * @brief The number of times the heartbeat window was exceeded.
+     */
+    uint64_t lapses;
+    /**
+     * @brief The smallest time left in the heartbeat window when a
+     *        heartbeat arrived, in nanoseconds.
+     */
+    uint64_t min_heartbeat_margin_ns;
+    /**
+     * @brief The latest a refresh ran after it was due, in nanoseconds.
+     */
+    uint64_t max_kick_late_ns;
+} accesio_pci_wdg_service_status;
+
+/**
+ * @brief Describes the debounce filter for the input ports of a PCI-IIRO
+ *        or PCI-IDIO card. Each input bit must hold a new level for its
+ *        port's stable time before the change is accepted; only accepted
+ *        changes wake interrupt waiters and are queued as events.
+ */
+typedef struct accesio_pci_debounce_config {
+    /**
+     * @brief The time between samples of the inputs in nanoseconds, at
+     *        least ACCESIO_PCI_DEBOUNCE_SAMPLE_MIN.
+     */
+    uint64_t sample_ns;
+    /**
+     * @brief The time, in nanoseconds, an input of each port must hold a
+     *        level before the change is accepted.
+     */
+    uint64_t stable_ns[ACCESIO_PCI_DEBOUNCE_PORTS];
+    /**
+     * @brief The register offset of each input port (e.g. 0x1 for the
+     *        inputs of a PCI-IIRO-8, 0x1 and 0x5 for a PCI-IIRO-16).
+     */
+    uint16_t offset[ACCESIO_PCI_DEBOUNCE_PORTS];
+    /**
+     * @brief The number of ports in `offset`, at most ACCESIO_PCI_DEBOUNCE_PORTS.
+     */
+    uint8_t ports;
+    /**
+     * @brief The region of the input ports, 0 selects the main BAR.
+     */
+    uint8_t bar;
+    /**
+     * @brief The number of events the queue can hold, 0 selects
+     *        ACCESIO_PCI_DEBOUNCE_EVENTS_DEFAULT.
+     */
+    uint32_t queue_events;
+} accesio_pci_debounce_config;
+
+/**
+ * @brief A debounced change of an input port.
+ */
+typedef struct accesio_pci_debounce_event {
+    /**
+     * @brief The CLOCK_MONOTONIC time, in nanoseconds, the changed inputs
+     *        last moved before they were accepted as stable.
+     */
+    uint64_t timestamp_ns;
+    /**
+     * @brief The port that changed.
+     */
+    uint8_t port;
+    /**
+     * @brief The debounced value of the port after the change.
+     */
+    uint8_t value;
+    /**
+     * @brief The bits of the port that changed.
+     */
+    uint8_t changed;
+} accesio_pci_debounce_event;
+
+/**
+ * @brief A buffer that queued debounce events are read into.
+ */
+typedef struct accesio_pci_debounce_events {
+    /**
+     * @brief The buffer the events are read into.
+     */
+    accesio_pci_debounce_event* events;
+    /**
+     * @brief The number of events `events` can hold.
+     */
+    uint32_t count;
+} accesio_pci_debounce_events;
+
+/**
+ * @brief Describes the state of the debounce filter.
+ */
+typedef struct accesio_pci_debounce_status {
+    /**
+     * @brief Non-zero if the filter is running.
+     */
+    uint8_t running;
+    /**
+     * @brief The number of ports filtered.
+     */
+    uint8_t ports;
+    /**
+     * @brief The debounced value of each port.
+     */
+    uint8_t values[ACCESIO_PCI_DEBOUNCE_PORTS];
+    /**
+     * @brief The number of events waiting in the queue.
+     */
+    uint32_t queued;
+    /**
+     * @brief The number of times the inputs were sampled.
+     */
+    uint64_t samples;
+    /**
+     * @brief The number of raw input bit changes seen, including bounces.
+     */
+    uint64_t bounces;
+    /**
+     * @brief The number of debounced port changes.
+     */
+    uint64_t transitions;
+    /**
+     * @brief The number of change of state interrupts absorbed by the filter.
+     */
+    uint64_t interrupts;
+    /**
+     * @brief The number of events lost because the queue was full.
+     */
+    uint64_t dropped;
+} accesio_pci_debounce_status;
+
+/**
+ * @brief Selects the 8254 counters latched by a counter capture. All the
+ *        selected counters of a chip are latched by a single read-back
+ *        command, and the chips are latched back to back.
+ */
+typedef struct accesio_pci_counter_config {
+    /**
+     * @brief The register offset of each 8254 chip.
+     */
+    uint16_t chip_offset[ACCESIO_PCI_COUNTER_CHIPS];
+    /**
+     * @brief The counters captured on each chip, bit 0 for counter 0
+     *        through bit 2 for counter 2.
+     */
+    uint8_t mask[ACCESIO_PCI_COUNTER_CHIPS];
+    /**
+     * @brief The number of chips in `chip_offset`, at most ACCESIO_PCI_COUNTER_CHIPS.
+     */
+    uint8_t chips;
+    /**
+     * @brief The region of the chips, 0 selects the main BAR.
+     */
+    uint8_t bar;
+} accesio_pci_counter_config;
+
+/**
+ * @brief The latched values of a counter capture.
+ */
+typedef struct accesio_pci_counter_sample {
+    /**
+     * @brief The CLOCK_MONOTONIC time, in nanoseconds, just before the
+     *        counters were latched.
+     */
+    uint64_t timestamp_ns;
+    /**
+     * @brief The value of each counter, indexed by chip then counter;
+     *        counters not in the mask read 0.
+     */
+    uint16_t counts[ACCESIO_PCI_COUNTER_CHIPS][3];
+} accesio_pci_counter_sample;
+
+/**
+ * @brief A single counter capture.
+ */
+typedef struct accesio_pci_counter_capture {
+    /**
+     * @brief The counters to capture.
+     */
+    accesio_pci_counter_config config;
+    /**
+     * @brief Set by the driver to the captured values.
+     */
+    accesio_pci_counter_sample sample;
+} accesio_pci_counter_capture;
+
+/**
+ * @brief Describes periodic counter captures pushed into a kernel queue.
+ */
+typedef struct accesio_pci_counter_periodic {
+    /**
+     * @brief The counters to capture.
+     */
+    accesio_pci_counter_config config;
+    /**
+     * @brief The time between captures in nanoseconds, at least
+     *        ACCESIO_PCI_COUNTER_PERIOD_MIN.
+     */
+    uint64_t period_ns;
+    /**
+     * @brief The number of captures the queue can hold, 0 selects
+     *        ACCESIO_PCI_COUNTER_QUEUE_DEFAULT.
+     */
+    uint32_t queue_samples;
+} accesio_pci_counter_periodic;
+
+/**
+ * @brief A buffer that queued periodic captures are read into.
+ */
+typedef struct accesio_pci_counter_samples {
+    /**
+     * @brief The buffer the captures are read into.
+     */
+    accesio_pci_counter_sample* samples;
+    /**
+     * @brief The number of captures `samples` can hold.
+     */
+    uint32_t count;
+    /**
+     * @brief Set by the driver to the number of captures lost because
+     *        the queue was full since periodic capture started.
+     */
+    uint64_t dropped;
+} accesio_pci_counter_samples;
+
+/**
+ * @brief A single digital line used by a bit-banged transfer.
+ */
+typedef struct accesio_pci_bitbang_pin {
+    /**
+     * @brief The offset of the byte register holding the line.
+     */
+    uint16_t offset;
+    /**
+     * @brief The bit of the line in the register, 0 to 7.
+     */
+    uint8_t bit;
+} accesio_pci_bitbang_pin;
+
+/**
+ * @brief Describes a bit-banged SPI or shift register transfer run in the
+ *        driver. Output lines are updated read-modify-write, so other bits
+ *        of the same registers keep their value.
+ */
+typedef struct accesio_pci_bitbang_transfer {
+    /**
+     * @brief The bytes shifted out on `mosi`, NULL leaves the line alone.
+     */
+    uint8_t* tx;
+    /**
+     * @brief The buffer the bytes sampled on `miso` are stored in, NULL
+     *        skips sampling.
+     */
+    uint8_t* rx;
+    /**
+     * @brief The number of bytes to transfer, at most ACCESIO_PCI_BITBANG_MAX.
+     */
+    uint32_t length;
+    /**
+     * @brief The delay between clock edges in nanoseconds, at most
+     *        ACCESIO_PCI_BITBANG_HALF_PERIOD_MAX.
+     */
+    uint32_t half_period_ns;
+    /**
+     * @brief The clock output.
+     */
+    accesio_pci_bitbang_pin clock;
+    /**
+     * @brief The data output.
+     */
+    accesio_pci_bitbang_pin mosi;
+    /**
+     * @brief The data input.
+     */
+    accesio_pci_bitbang_pin miso;
+    /**
+     * @brief The chip select output, used with ACCESIO_PCI_BITBANG_CS.
+     */
+    accesio_pci_bitbang_pin cs;
+    /**
+     * @brief The SPI mode 0 to 3, bit 1 is the clock polarity and bit 0
+     *        the clock phase.
+     */
+    uint8_t mode;
+    /**
+     * @brief A combination of the ACCESIO_PCI_BITBANG flags.
+     */
+    uint8_t flags;
+    /**
+     * @brief The region of the lines, 0 selects the main BAR.
+     */
+    uint8_t bar;
+} accesio_pci_bitbang_transfer;
+
+/**
+ * @brief The input lines of one quadrature encoder.
+ */
+typedef struct accesio_pci_quadrature_channel {
+    /**
+     * @brief The offset of the byte register holding phase A.
+     */
+    uint16_t a_offset;
+    /**
+     * @brief The offset of the byte register holding phase B.
+     */
+    uint16_t b_offset;
+    /**
+     * @brief The bit of phase A in its register, 0 to 7.
+     */
+    uint8_t a_bit;
+    /**
+     * @brief The bit of phase B in its register, 0 to 7.
+     */
+    uint8_t b_bit;
+} accesio_pci_quadrature_channel;
+
+/**
+ * @brief Describes the encoders decoded by the driver. The inputs are
+ *        sampled on a fixed period, which must be shorter than the time
+ *        between two edges of an encoder at its highest speed.
+ */
+typedef struct accesio_pci_quadrature_config {
+    /**
+     * @brief The lines of each encoder.
+     */
+    accesio_pci_quadrature_channel channel[ACCESIO_PCI_QUADRATURE_CHANNELS];
+    /**
+     * @brief The time between samples in nanoseconds, at least
+     *        ACCESIO_PCI_QUADRATURE_PERIOD_MIN.
+     */
+    uint32_t period_ns;
+    /**
+     * @brief The number of encoders in `channel`, at most
+     *        ACCESIO_PCI_QUADRATURE_CHANNELS.
+     */
+    uint8_t channels;
+    /**
+     * @brief The region of the inputs, 0 selects the main BAR.
+     */
+    uint8_t bar;
+} accesio_pci_quadrature_config;
+
+/**
+ * @brief The counters of the quadrature decoder, all taken at one instant.
+ */
+typedef struct accesio_pci_quadrature_counts {
+    /**
+     * @brief The signed position of each encoder in quadrature counts,
+     *        four per encoder line.
+     */
+    int64_t position[ACCESIO_PCI_QUADRATURE_CHANNELS];
+    /**
+     * @brief The number of samples where both phases of an encoder changed
+     *        at once; the direction of such a step is unknown and the
+     *        position is left unchanged.
+     */
+    uint64_t errors[ACCESIO_PCI_QUADRATURE_CHANNELS];
+    /**
+     * @brief The number of samples taken since the decoder started.
+     */
+    uint64_t samples;
+    /**
+     * @brief The number of sample periods skipped because the timer ran
+     *        late, counts may have been lost across them.
+     */
+    uint64_t missed;
+    /**
+     * @brief The CLOCK_MONOTONIC time, in nanoseconds, of the last sample.
+     */
+    uint64_t timestamp_ns;
+    /**
+     * @brief The number of encoders decoded, 0 when the decoder is stopped.
+     */
+    uint8_t channels;
+} accesio_pci_quadrature_counts;
+
+/**
+ * @brief A register write executed by the driver at a given time.
+ */
+typedef struct accesio_pci_timed_write {
+    /**
+     * @brief The CLOCK_MONOTONIC time, in nanoseconds, to write at. A time
+     *        already past is written as soon as possible.
+     */
+    uint64_t deadline_ns;
+    /**
+     * @brief A value chosen by the application to identify the write in
+     *        completions and cancellations.
+     */
+    uint32_t tag;
+    /**
+     * @brief The bits of the register changed; the others are read back
+     *        and kept. Must not be 0.
+     */
+    uint32_t mask;
+    /**
+     * @brief The value of the bits in `mask`.
+     */
+    uint32_t value;
+    /**
+     * @brief The offset of the register.
+     */
+    uint16_t offset;
+    /**
+     * @brief The size of the register, ACCESIO_BYTE, ACCESIO_WORD or ACCESIO_DWORD.
+     */
+    uint8_t size;
+    /**
+     * @brief The region of the register, 0 selects the main BAR.
+     */
+    uint8_t bar;
+} accesio_pci_timed_write;
+
+/**
+ * @brief A list of timed writes to queue, or the buffer the pending writes
+ *        are copied into.
+ */
+typedef struct accesio_pci_timed_writes {
+    /**
+     * @brief The writes.
+     */
+    accesio_pci_timed_write* entries;
+    /**
+     * @brief The number of writes in `entries`.
+     */
+    uint32_t count;
+} accesio_pci_timed_writes;
+
+/**
+ * @brief Records when a timed write was executed.
+ */
+typedef struct accesio_pci_timed_completion {
+    /**
+     * @brief The requested time in nanoseconds.
+     */
+    uint64_t deadline_ns;
+    /**
+     * @brief The CLOCK_MONOTONIC time, in nanoseconds, right after the
+     *        register was written.
+     */
+    uint64_t executed_ns;
+    /**
+     * @brief The tag of the write.
+     */
+    uint32_t tag;
+} accesio_pci_timed_completion;
+
+/**
+ * @brief A buffer that completions are read into.
+ */
+typedef struct accesio_pci_timed_completions {
+    /**
+     * @brief The buffer the completions are read into.
+     */
+    accesio_pci_timed_completion* completions;
+    /**
+     * @brief The number of completions `completions` can hold.
+     */
+    uint32_t count;
+    /**
+     * @brief Set by the driver to the number of completions lost because
+     *        they were not read in time.
+     */
+    uint64_t dropped;
+} accesio_pci_timed_completions;
+
 #endif // ACCESIO_PCIDEV_H
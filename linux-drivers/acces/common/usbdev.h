@@ -131,4 +131,525 @@ typedef struct accesio_usb_info {
     unsigned kernel_usb_lpm_disable_count;
 } accesio_usb_info;
 
+/**
+ * @brief The usage of one of the buffers synchronous transfers are copied
+ *        through.
+ */
+typedef struct accesio_usb_buffer_stats {
+    /**
+     * @brief The number of transfers that fit the buffer.
+     */
+    uint64_t reuses;
+    /**
+     * @brief The number of times the buffer was allocated, once when the
+     *        device is probed and then for each transfer that outgrew it.
+     */
+    uint64_t grows;
+    /**
+     * @brief The current size of the buffer in bytes.
+     */
+    uint32_t size;
+} accesio_usb_buffer_stats;
+
+/**
+ * @brief The usage of the buffers of each endpoint and direction.
+ */
+typedef struct accesio_usb_bounce_stats {
+    accesio_usb_buffer_stats bulk_in;
+    accesio_usb_buffer_stats bulk_out;
+    accesio_usb_buffer_stats control_in;
+    accesio_usb_buffer_stats control_out;
+} accesio_usb_bounce_stats;
+
+/**
+ * @brief The direction of a USB transfer.
+ */
+enum accesio_usb_direction {
+    ACCESIO_USB_DIR_OUT = 0,
+    ACCESIO_USB_DIR_IN = 1
+};
+
+/**
+ * @brief Describes a synchronous bulk transfer of any size. Transfers of at
+ *        least ACCESIO_USB_ZEROCOPY_MIN bytes are done directly from or to
+ *        the user buffer, smaller ones are copied.
+ */
+typedef struct accesio_usb_bulk_transfer {
+    /**
+     * @brief The data to send, or the buffer the data read is stored in.
+     *        From ACCESIO_USB_ZEROCOPY_MIN bytes it must be aligned to the
+     *        endpoint's packet size on most host controllers.
+     */
+    void* data;
+    /**
+     * @brief The number of bytes to transfer, at most ACCESIO_USB_ZEROCOPY_MAX.
+     */
+    uint32_t length;
+    /**
+     * @brief Set by the driver to the number of bytes transferred, which
+     *        is also valid when the transfer failed part way.
+     */
+    uint32_t actual_length;
+    /**
+     * @brief The time the whole transfer may take in milliseconds, 0
+     *        selects ACCESIO_USB_TIMEOUT_DEFAULT.
+     */
+    uint32_t timeout_ms;
+    /**
+     * @brief The direction of the transfer, see `accesio_usb_direction`.
+     */
+    uint8_t direction;
+} accesio_usb_bulk_transfer;
+
+/**
+ * @brief One vendor control transfer of a batch.
+ */
+typedef struct accesio_usb_control_transfer {
+    /**
+     * @brief The data to send, or the buffer the data read is stored in.
+     */
+    void* data;
+    /**
+     * @brief Set by the driver to the number of bytes transferred, or to
+     *        the negative error code the transfer failed with.
+     */
+    int32_t status;
+    /**
+     * @brief The vendor request.
+     */
+    uint8_t request;
+    /**
+     * @brief The direction of the transfer, see `accesio_usb_direction`.
+     */
+    uint8_t direction;
+    /**
+     * @brief The value of the request.
+     */
+    uint16_t value;
+    /**
+     * @brief The index of the request.
+     */
+    uint16_t index;
+    /**
+     * @brief The number of bytes to transfer.
+     */
+    uint16_t length;
+} accesio_usb_control_transfer;
+
+/**
+ * @brief Vendor control transfers done back to back with one call.
+ */
+typedef struct accesio_usb_control_batch {
+    /**
+     * @brief The transfers, done in order, each one's status is set.
+     */
+    accesio_usb_control_transfer* transfers;
+    /**
+     * @brief The number of transfers, at most ACCESIO_USB_CONTROL_BATCH_MAX.
+     */
+    uint32_t count;
+    /**
+     * @brief Non-zero to skip the transfers after the first one that
+     *        failed, their status is set to -ECANCELED.
+     */
+    uint32_t stop_on_error;
+} accesio_usb_control_batch;
+
+/**
+ * @brief A bulk or vendor control transfer submitted without waiting for
+ *        it to complete. The same structure is returned when the transfer
+ *        is reaped.
+ */
+typedef struct accesio_usb_async_request {
+    /**
+     * @brief The data to send, or the buffer the data read is stored in
+     *        when the transfer is reaped. It must stay valid until then.
+     */
+    void* data;
+    /**
+     * @brief Any value, returned unchanged when the transfer is reaped.
+     */
+    uint64_t user_context;
+    /**
+     * @brief Set by the driver on submit to the tag identifying the
+     *        transfer for a discard.
+     */
+    uint64_t tag;
+    /**
+     * @brief The number of bytes to transfer, at most ACCESIO_USB_ASYNC_LENGTH_MAX.
+     */
+    uint32_t length;
+    /**
+     * @brief Set by the driver on reap to the number of bytes transferred.
+     */
+    uint32_t actual_length;
+    /**
+     * @brief Set by the driver on reap to the status of the transfer,
+     *        0 or a negative error code; -ECONNRESET if it was discarded.
+     */
+    int32_t status;
+    /**
+     * @brief ACCESIO_USB_IOCTL_BULK_MSG or ACCESIO_USB_IOCTL_CTRL_MSG.
+     */
+    uint8_t msg_type;
+    /**
+     * @brief The direction of the transfer, see `accesio_usb_direction`.
+     */
+    uint8_t direction;
+    /**
+     * @brief The vendor request, only used by control transfers.
+     */
+    uint8_t request;
+    /**
+     * @brief The request value, only used by control transfers.
+     */
+    uint16_t value;
+    /**
+     * @brief The request index, only used by control transfers.
+     */
+    uint16_t index;
+} accesio_usb_async_request;
+
+/**
+ * @brief Describes a bulk stream kept going by the driver with several
+ *        URBs queued at all times.
+ */
+typedef struct accesio_usb_stream_config {
+    /**
+     * @brief The number of URBs kept queued, at most
+     *        ACCESIO_USB_STREAM_URBS_MAX, 0 selects ACCESIO_USB_STREAM_URBS_DEFAULT.
+     */
+    uint32_t urb_count;
+    /**
+     * @brief The size of each URB in bytes, a multiple of the endpoint's
+     *        packet size up to ACCESIO_USB_STREAM_URB_SIZE_MAX, 0 selects
+     *        ACCESIO_USB_STREAM_URB_SIZE_DEFAULT.
+     */
+    uint32_t urb_size;
+    /**
+     * @brief The size of the kernel ring in bytes, a power of two of at
+     *        least twice `urb_count * urb_size` up to
+     *        ACCESIO_USB_STREAM_RING_MAX, 0 selects four times that.
+     */
+    uint32_t ring_size;
+    /**
+     * @brief Output streams only, the number of bytes in the ring at or
+     *        below which writers are woken and poll() reports POLLOUT,
+     *        0 selects half the ring.
+     */
+    uint32_t low_water;
+} accesio_usb_stream_config;
+
+/**
+ * @brief The first page of a bulk-in stream's mapping, the ring of
+ *        `ring_size` bytes starts `data_offset` bytes into the mapping.
+ *        The bytes from `tail` up to `head` are valid, both run freely and
+ *        are taken modulo `ring_size`.
+ */
+typedef struct accesio_usb_stream_control {
+    /**
+     * @brief The number of bytes the driver stored, read it with acquire
+     *        semantics before reading the data.
+     */
+    uint32_t head;
+    /**
+     * @brief The number of bytes consumed, advanced by the application
+     *        with release semantics once it is done with the data.
+     */
+    uint32_t tail;
+    /**
+     * @brief The size of the ring in bytes.
+     */
+    uint32_t ring_size;
+    /**
+     * @brief The offset of the ring from the start of the mapping.
+     */
+    uint32_t data_offset;
+    /**
+     * @brief The number of bytes lost because the ring was full.
+     */
+    uint64_t overruns;
+} accesio_usb_stream_control;
+
+/**
+ * @brief The state and counters of a bulk stream.
+ */
+typedef struct accesio_usb_stream_status {
+    /**
+     * @brief The number of bytes moved between the device and the ring.
+     */
+    uint64_t bytes;
+    /**
+     * @brief The number of bytes received while the input ring was full
+     *        and therefore lost.
+     */
+    uint64_t overruns;
+    /**
+     * @brief The number of times an output stream ran dry, every URB
+     *        having completed with the ring empty.
+     */
+    uint64_t underruns;
+    /**
+     * @brief The number of URBs that completed with an error.
+     */
+    uint64_t errors;
+    /**
+     * @brief The number of URBs completed.
+     */
+    uint64_t urbs;
+    /**
+     * @brief The number of bytes in the ring, waiting to be read or sent.
+     */
+    uint32_t available;
+    /**
+     * @brief The size of the ring in bytes, 0 when no stream was started.
+     */
+    uint32_t ring_size;
+    /**
+     * @brief The error that stopped the stream, 0 if it is running or
+     *        was stopped on request.
+     */
+    int32_t error;
+    /**
+     * @brief Non-zero while the stream is running.
+     */
+    uint8_t running;
+} accesio_usb_stream_status;
+
+/**
+ * @brief The use of the URBs preallocated for `write()`.
+ */
+typedef struct accesio_usb_write_pool_stats {
+    /**
+     * @brief The number of writes that submitted a URB.
+     */
+    uint64_t writes;
+    /**
+     * @brief The number of writes that found every URB in flight and had
+     *        to wait, or returned -EAGAIN.
+     */
+    uint64_t exhausted;
+    /**
+     * @brief The number of URBs in the pool, the most writes in flight.
+     */
+    uint32_t depth;
+    /**
+     * @brief The number of URBs not in flight.
+     */
+    uint32_t available;
+} accesio_usb_write_pool_stats;
+
+/**
+ * @brief Used to merge small `write()` calls into shared transfers.
+ */
+typedef struct accesio_usb_write_coalesce {
+    /**
+     * @brief Writes smaller than this many bytes are merged into one
+     *        transfer until it holds this many, 0 turns merging off. At
+     *        most the size of a `write()` transfer.
+     */
+    uint32_t size;
+    /**
+     * @brief The most microseconds merged data waits before it is sent
+     *        anyway, 0 selects ACCESIO_USB_COALESCE_DELAY_DEFAULT.
+     */
+    uint32_t delay_us;
+} accesio_usb_write_coalesce;
+
+/**
+ * @brief A report received on the interrupt-IN endpoint.
+ */
+typedef struct accesio_usb_interrupt_report {
+    /**
+     * @brief The CLOCK_MONOTONIC time the report arrived, in nanoseconds.
+     */
+    uint64_t timestamp_ns;
+    /**
+     * @brief The number of the report since the listener started, a gap
+     *        means reports were dropped.
+     */
+    uint32_t sequence;
+    /**
+     * @brief The number of bytes in `data`.
+     */
+    uint16_t length;
+    /**
+     * @brief The report, cut to ACCESIO_USB_INTERRUPT_REPORT_MAX bytes.
+     */
+    uint8_t data[ACCESIO_USB_INTERRUPT_REPORT_MAX];
+} accesio_usb_interrupt_report;
+
+/**
+ * @brief Used to read the queued interrupt-IN reports.
+ */
+typedef struct accesio_usb_interrupt_reports {
+    /**
+     * @brief The buffer the reports are read into.
+     */
+    accesio_usb_interrupt_report* reports;
+    /**
+     * @brief The number of reports `reports` can hold.
+     */
+    uint32_t count;
+    /**
+     * @brief Set by the driver to the error that stopped the listener, 0
+     *        while it runs or if it was stopped on request.
+     */
+    int32_t error;
+    /**
+     * @brief Set by the driver to the number of reports lost because the
+     *        queue was full since the listener started.
+     */
+    uint64_t dropped;
+} accesio_usb_interrupt_reports;
+
+/**
+ * @brief The completion of a transfer of the bulk-in stream.
+ */
+typedef struct accesio_usb_stream_timestamp {
+    /**
+     * @brief The CLOCK_MONOTONIC time the transfer completed, in
+     *        nanoseconds.
+     */
+    uint64_t timestamp_ns;
+    /**
+     * @brief The stream offset of the transfer's first byte, the number of
+     *        bytes the device sent before it, including those lost to
+     *        overruns, as used by `accesio_usb_stream_clock`.
+     */
+    uint64_t offset;
+    /**
+     * @brief The read position of the transfer's first byte, the number of
+     *        bytes the stream stored before it.
+     */
+    uint64_t position;
+    /**
+     * @brief The bytes of the transfer stored in the ring, the first ones
+     *        of the transfer.
+     */
+    uint32_t length;
+    /**
+     * @brief The bytes of the transfer lost because the ring was full.
+     */
+    uint32_t dropped;
+} accesio_usb_stream_timestamp;
+
+/**
+ * @brief Used to read the completion timestamps of the bulk-in stream.
+ */
+typedef struct accesio_usb_stream_timestamps {
+    /**
+     * @brief The buffer the timestamps are read into.
+     */
+    accesio_usb_stream_timestamp* stamps;
+    /**
+     * @brief The number of timestamps `stamps` holds.
+     */
+    uint32_t count;
+    /**
+     * @brief Set by the driver to the number of timestamps lost because
+     *        they weren't read in time.
+     */
+    uint64_t dropped;
+} accesio_usb_stream_timestamps;
+
+/**
+ * @brief The streams the clock estimate is kept for.
+ */
+enum accesio_usb_stream_id {
+    ACCESIO_USB_STREAM_IN = 0,
+    ACCESIO_USB_STREAM_OUT = 1
+};
+
+/**
+ * @brief The estimate of the device's data clock against CLOCK_MONOTONIC,
+ *        from the latest transfer completions of a stream. The time of
+ *        stream byte `n` is `ref_ns + ((n - ref_offset) * ns_per_byte_q32) / 2^32`,
+ *        where for the bulk-in stream `n` counts the bytes lost to overruns
+ *        too; `accesio_usb_stream_timestamp` relates it to read positions.
+ */
+typedef struct accesio_usb_stream_clock {
+    /**
+     * @brief The stream to estimate, see `accesio_usb_stream_id`.
+     */
+    uint32_t stream;
+    /**
+     * @brief Set by the driver to the number of completions used.
+     */
+    uint32_t points;
+    /**
+     * @brief Set by the driver to the stream offset of the reference point,
+     *        bytes produced or consumed by the device, including those lost
+     *        to overruns.
+     */
+    uint64_t ref_offset;
+    /**
+     * @brief Set by the driver to the CLOCK_MONOTONIC time of the reference
+     *        point, in nanoseconds.
+     */
+    uint64_t ref_ns;
+    /**
+     * @brief Set by the driver to the nanoseconds per byte, with 32
+     *        fractional bits.
+     */
+    uint64_t ns_per_byte_q32;
+    /**
+     * @brief Set by the driver to the rate in bytes per second.
+     */
+    uint64_t bytes_per_second;
+} accesio_usb_stream_clock;
+
+/**
+ * @brief The header of a packet received by the isochronous stream, the
+ *        data follows it, padded to a multiple of 8 bytes.
+ */
+typedef struct accesio_usb_iso_packet {
+    /**
+     * @brief The CLOCK_MONOTONIC time the packet was received, in
+     *        nanoseconds, estimated from the completion of its URB.
+     */
+    uint64_t timestamp_ns;
+    /**
+     * @brief The (micro)frame number the packet was scheduled in.
+     */
+    uint32_t frame;
+    /**
+     * @brief The status of the packet, 0 or a negative error code.
+     */
+    int32_t status;
+    /**
+     * @brief The number of data bytes following the header.
+     */
+    uint32_t length;
+    /**
+     * @brief The number of the packet since the stream started, a gap
+     *        means packets were dropped because the ring was full.
+     */
+    uint32_t sequence;
+} accesio_usb_iso_packet;
+
+/**
+ * @brief Used to read packets from the isochronous stream.
+ */
+typedef struct accesio_usb_iso_packets {
+    /**
+     * @brief The buffer the packets are read into, each an
+     *        accesio_usb_iso_packet followed by its padded data.
+     */
+    void* data;
+    /**
+     * @brief The size of `data` in bytes.
+     */
+    uint32_t length;
+    /**
+     * @brief Set by the driver to the number of bytes read, whole packets
+     *        only.
+     */
+    uint32_t actual_length;
+    /**
+     * @brief Set by the driver to the number of packets read.
+     */
+    uint32_t packets;
+} accesio_usb_iso_packets;
+
 #endif // ACCESIO_USBDEV_H
@@ -71,7 +71,7 @@ static void accesio_pci_device_set_irq_data(accesio_pci_device_info* ddata, uint
         case ACCESIO_PCI_DIO_24H: case ACCESIO_PCI_DIO_24D: case ACCESIO_PCI_DIO_24H_C: case ACCESIO_PCI_DIO_24D_C:
         case ACCESIO_PCI_DIO_24S: case ACCESIO_PCI_DIO_48: case ACCESIO_PCI_DIO_48S: case ACCESIO_P104_DIO_48S:
         case ACCESIO_PCI_DIO_72: case ACCESIO_PCI_DIO_96: case ACCESIO_PCI_DIO_96C3: case ACCESIO_PCI_DIO_120:
-        case ACCESIO_PCI_AI12_16: case ACCESIO_PCI_AI12_16A: case ACCESIO_PCI_A12_16A: case ACCESIO_LPCI_IIRO_8:
+        case ACCESIO_PCI_AI12_16: case ACCESIO_PCI_AI12_16A: case ACCESIO_PCI_AIO12_16: case ACCESIO_PCI_A12_16A: case ACCESIO_LPCI_IIRO_8:
         case ACCESIO_PCI_IIRO_8: case ACCESIO_PCI_IIRO_16: case ACCESIO_PCI_IDI_48: case ACCESIO_PCI_IDIO_16:
         case ACCESIO_LPCI_A16_16A: case ACCESIO_PCI_DA12_16: case ACCESIO_PCI_DA12_8:
             ddata->irq_capable = true;
@@ -179,6 +179,34 @@ static int accesio_pci_alloc_driver(accesio_pci_device_info** device, struct pci
     (*device)->is_pcie = ((*device)->plx_region.length >= 0x100);
     // TODO: bar 2 
 
+    init_waitqueue_head(&((*device)->ai_stream.wait));
+    mutex_init(&((*device)->ai_stream.lock));
+    init_waitqueue_head(&((*device)->da_playback.wait));
+    mutex_init(&((*device)->da_playback.lock));
+    spin_lock_init(&((*device)->da_playback.bank_lock));
+    ACCES_HRTIMER_SETUP(&((*device)->da_playback.timer), accesio_pci_da_playback_tick, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    init_waitqueue_head(&((*device)->dio_pattern.wait));
+    mutex_init(&((*device)->dio_pattern.lock));
+    spin_lock_init(&((*device)->dio_pattern.step_lock));
+    ACCES_HRTIMER_SETUP(&((*device)->dio_pattern.timer), accesio_pci_dio_pattern_tick, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+    spin_lock_init(&((*device)->wdg_service.lock));
+    ACCES_HRTIMER_SETUP(&((*device)->wdg_service.timer), accesio_pci_wdg_service_tick, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    init_waitqueue_head(&((*device)->debounce.wait));
+    mutex_init(&((*device)->debounce.lock));
+    spin_lock_init(&((*device)->debounce.state_lock));
+    ACCES_HRTIMER_SETUP(&((*device)->debounce.timer), accesio_pci_debounce_tick, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    init_waitqueue_head(&((*device)->counter.wait));
+    mutex_init(&((*device)->counter.lock));
+    spin_lock_init(&((*device)->counter.latch_lock));
+    ACCES_HRTIMER_SETUP(&((*device)->counter.timer), accesio_pci_counter_tick, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    mutex_init(&((*device)->bitbang_lock));
+    spin_lock_init(&((*device)->quadrature.lock));
+    ACCES_HRTIMER_SETUP(&((*device)->quadrature.timer), accesio_pci_quadrature_tick, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    init_waitqueue_head(&((*device)->timed.wait));
+    mutex_init(&((*device)->timed.lock));
+    spin_lock_init(&((*device)->timed.queue_lock));
+    ACCES_HRTIMER_SETUP(&((*device)->timed.timer), accesio_pci_timed_tick, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+
     atomic_set(&((*device)->open_count), 0);
     return ACCESIO_SUCCESS;
 }
@@ -251,6 +279,8 @@ static irqreturn_t accesio_pci_interrupt_5(int irq, void* dev_id)
     if (!accesio_pci_interrupt_main(ddata)) { return IRQ_NONE; }
     //apci_devel("Interrupt for PCIe_IIRO_8");
     outb(0, ddata->regions[2].start + 0x1);
+    // while debouncing only accepted transitions wake the waiters
+    if (accesio_pci_debounce_cos(ddata)) { return IRQ_HANDLED; }
     accesio_pci_interrupt_irq_lock(ddata);
     return IRQ_HANDLED;
 }
@@ -264,6 +294,23 @@ static irqreturn_t accesio_pci_interrupt_6(int irq, void* dev_id)
     return IRQ_HANDLED;
 }
 
+static void accesio_pci_ai_stream_drain(accesio_pci_device_info* ddata)
+{
+    accesio_pci_ai_stream* stream = &ddata->ai_stream;
+    uint16_t sample = 0;
+    uint32_t count = 0;
+    /* The FIFO is always drained, even when the ring is full, otherwise
+     * the card overflows and the stream is lost rather than just late. */
+    for (count = 0; count < stream->samples_per_irq; ++count) {
+        sample = inw(ddata->regions[2].start + ACCESIO_PCI_AI12_FIFO);
+        if (kfifo_in(&stream->ring, &sample, 1) == 0) {
+            ++stream->overruns;
+        }
+    }
+    stream->samples += count;
+    ++stream->interrupts;
+}
+
 static irqreturn_t accesio_pci_interrupt_7(int irq, void* dev_id)
 {
     accesio_pci_device_info* ddata = (accesio_pci_device_info*)dev_id;
@@ -273,9 +320,19 @@ static irqreturn_t accesio_pci_interrupt_7(int irq, void* dev_id)
     * the counter enabled.  Otherwise the IRQ will not
     * go away and user code will never run as the machine
     * will hang in a never-ending IRQ loop. The userland
-    * irq routine must re-enable the interrupts if desired. */
-    outb(0x01, ddata->regions[2].start + 0x04);
-    inb(ddata->regions[2].start + 0x04);
+    * irq routine must re-enable the interrupts if desired,
+    * unless the FIFO is being streamed by the driver. */
+    outb(ACCESIO_PCI_AI12_IRQ_FIFO_OFF, ddata->regions[2].start + ACCESIO_PCI_AI12_IRQ_CTRL);
+    inb(ddata->regions[2].start + ACCESIO_PCI_AI12_IRQ_CTRL);
+    spin_lock(&(ddata->irq_lock));
+    if (ddata->ai_stream.running) {
+        accesio_pci_ai_stream_drain(ddata);
+        outb(ddata->ai_stream.irq_enable, ddata->regions[2].start + ACCESIO_PCI_AI12_IRQ_CTRL);
+        spin_unlock(&(ddata->irq_lock));
+        wake_up_interruptible(&(ddata->ai_stream.wait));
+    } else {
+        spin_unlock(&(ddata->irq_lock));
+    }
     accesio_pci_interrupt_irq_lock(ddata);
     return IRQ_HANDLED;
 }
@@ -424,59 +481,1737 @@ static inline int accesio_pci_ioctl_internal_get_device_info(accesio_pci_device_
     return ACCESIO_SUCCESS;
 }
 
+// register access shared by the ioctl path and the kernel side engines
+static inline void accesio_pci_region_write(accesio_pci_region* region, uint32_t offset, enum accesio_pci_ioctl_size size, uint32_t data)
+{
+    if (region->address_type == ACCESIO_ADDR_IO) {
+        switch (size) {
+            case ACCESIO_BYTE:  outb(data, region->start + offset); break;
+            case ACCESIO_WORD:  outw(data, region->start + offset); break;
+            case ACCESIO_DWORD: outl(data, region->start + offset); break;
+        };
+    } else { // MEM
+        void* tadd = region->mapped_address + offset;
+        switch(size) {
+            case ACCESIO_BYTE:  iowrite8(data, tadd); break;
+            case ACCESIO_WORD:  iowrite16(data, tadd); break;
+            case ACCESIO_DWORD: iowrite32(data, tadd); break;
+        };
+    }
+}
+
+static inline uint32_t accesio_pci_region_read(accesio_pci_region* region, uint32_t offset, enum accesio_pci_ioctl_size size)
+{
+    uint32_t data = 0;
+    if (region->address_type == ACCESIO_ADDR_IO) {
+        switch (size) {
+            case ACCESIO_BYTE:  data = inb(region->start + offset); break;
+            case ACCESIO_WORD:  data = inw(region->start + offset); break;
+            case ACCESIO_DWORD: data = inl(region->start + offset); break;
+        };
+    } else { // MEM
+        void* tadd = region->mapped_address + offset;
+        switch(size) {
+            case ACCESIO_BYTE:  data = ioread8(tadd); break;
+            case ACCESIO_WORD:  data = ioread16(tadd); break;
+            case ACCESIO_DWORD: data = ioread32(tadd); break;
+        };
+    }
+    return data;
+}
+
 static inline int accesio_pci_ioctl_internal_write(accesio_pci_device_info* ddata, unsigned long arg)
 {
-    int tmp = 0;
     accesio_pci_ioctl_packet iodata;
     if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_ioctl_packet)) == 0) { return -EACCES; }
-    tmp = copy_from_user(&iodata, (accesio_pci_ioctl_packet*)arg, sizeof(accesio_pci_ioctl_packet));
+    if (copy_from_user(&iodata, (accesio_pci_ioctl_packet*)arg, sizeof(accesio_pci_ioctl_packet)) != 0) { return -EIO; }
+    if (iodata.bar >= ACCESIO_MAX_REGIONS) { return -ENXIO; }
     if (ddata->regions[iodata.bar].address_type == ACCESIO_ADDR_INVALID) { return -ENXIO; }
     if (iodata.offset > ddata->regions[iodata.bar].length) { return -EFAULT; }
-    if (ddata->regions[iodata.bar].address_type == ACCESIO_ADDR_IO) {
-        tmp = ddata->regions[iodata.bar].start + iodata.offset;
-        switch (iodata.size) {
-            case ACCESIO_BYTE:  outb(iodata.data, tmp); break;
-            case ACCESIO_WORD:  outw(iodata.data, tmp); break;
-            case ACCESIO_DWORD: outl(iodata.data, tmp); break;
-        };
-    } else { // MEM
-        void* tadd = ddata->regions[iodata.bar].mapped_address + iodata.offset;
-        switch(iodata.size) {
-            case ACCESIO_BYTE:  iowrite8(iodata.data, tadd); break;
-            case ACCESIO_WORD:  iowrite16(iodata.data, tadd); break;
-            case ACCESIO_DWORD: iowrite32(iodata.data, tadd); break;
-        };
-    }
+    accesio_pci_region_write(&(ddata->regions[iodata.bar]), iodata.offset, iodata.size, iodata.data);
     return ACCESIO_SUCCESS;
 }
 
 static inline int accesio_pci_ioctl_internal_read(accesio_pci_device_info* ddata, unsigned long arg)
 {
-    int tmp = 0;
     accesio_pci_ioctl_packet iodata;
     if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_ioctl_packet)) == 0) { return -EACCES; }
-    tmp = copy_from_user(&iodata, (accesio_pci_ioctl_packet*)arg, sizeof(accesio_pci_ioctl_packet));
+    if (copy_from_user(&iodata, (accesio_pci_ioctl_packet*)arg, sizeof(accesio_pci_ioctl_packet)) != 0) { return -EIO; }
+    if (iodata.bar >= ACCESIO_MAX_REGIONS) { return -ENXIO; }
     if (ddata->regions[iodata.bar].address_type == ACCESIO_ADDR_INVALID) { return -ENXIO; }
     if (iodata.offset > ddata->regions[iodata.bar].length) { return -EFAULT; }
-    if (ddata->regions[iodata.bar].address_type == ACCESIO_ADDR_IO) {
-        tmp = ddata->regions[iodata.bar].start + iodata.offset;
-        switch (iodata.size) {
-            case ACCESIO_BYTE:  iodata.data = inb(tmp); break;
-            case ACCESIO_WORD:  iodata.data = inw(tmp); break;
-            case ACCESIO_DWORD: iodata.data = inl(tmp); break;
-        };
-    } else { // MEM
-        void* tadd = ddata->regions[iodata.bar].mapped_address + iodata.offset;
-        switch(iodata.size) {
-            case ACCESIO_BYTE:  iodata.data = ioread8(tadd); break;
-            case ACCESIO_WORD:  iodata.data = ioread16(tadd); break;
-            case ACCESIO_DWORD: iodata.data = ioread32(tadd); break;
-        };
-    }
+    iodata.data = accesio_pci_region_read(&(ddata->regions[iodata.bar]), iodata.offset, iodata.size);
     if (copy_to_user((accesio_pci_ioctl_packet*)arg, &iodata, sizeof(accesio_pci_ioctl_packet)) != 0) { return -EIO; }
     return ACCESIO_SUCCESS;
 }
 
+static bool accesio_pci_is_ai12(uint32_t product_id)
+{
+    switch (product_id) {
+        case ACCESIO_PCI_AI12_16: case ACCESIO_PCI_AI12_16A: case ACCESIO_PCI_AIO12_16: case ACCESIO_PCI_A12_16A:
+            return true;
+        default: break;
+    }
+    return false;
+}
+
+static void accesio_pci_ai_stream_stop(accesio_pci_device_info* ddata)
+{
+    unsigned long flags = 0;
+    spin_lock_irqsave(&(ddata->irq_lock), flags);
+    if (ddata->ai_stream.running) {
+        ddata->ai_stream.running = false;
+        outb(ACCESIO_PCI_AI12_IRQ_FIFO_OFF, ddata->regions[2].start + ACCESIO_PCI_AI12_IRQ_CTRL);
+    }
+    spin_unlock_irqrestore(&(ddata->irq_lock), flags);
+    // wake any readers so they can return what is left in the ring
+    wake_up_interruptible(&(ddata->ai_stream.wait));
+}
+
+static inline int accesio_pci_ioctl_internal_ai_stream_start(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    unsigned long flags = 0;
+    accesio_pci_ai_stream_config config;
+    accesio_pci_ai_stream* stream = &ddata->ai_stream;
+    if (!accesio_pci_is_ai12(ddata->product_id) || !ddata->irq_capable) { return -ENOSYS; }
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_ai_stream_config)) == 0) { return -EACCES; }
+    if (copy_from_user(&config, (accesio_pci_ai_stream_config*)arg, sizeof(accesio_pci_ai_stream_config)) != 0) { return -EIO; }
+    if (config.samples_per_irq == 0 || config.samples_per_irq > ACCESIO_PCI_AI_STREAM_DRAIN_MAX) { return -EINVAL; }
+    if (config.ring_samples == 0) { config.ring_samples = ACCESIO_PCI_AI_STREAM_RING_DEFAULT; }
+    if (config.ring_samples < config.samples_per_irq || config.ring_samples > ACCESIO_PCI_AI_STREAM_RING_MAX) { return -EINVAL; }
+    ret = mutex_lock_interruptible(&(stream->lock));
+    if (ret < 0) { return ret; }
+    if (stream->running) {
+        mutex_unlock(&(stream->lock));
+        return -EBUSY;
+    }
+    // the ring of the last stream is kept until now so it can be read out after a stop
+    kfifo_free(&(stream->ring));
+    ret = kfifo_alloc(&(stream->ring), config.ring_samples, GFP_KERNEL);
+    if (ret != 0) {
+        mutex_unlock(&(stream->lock));
+        return ret;
+    }
+    spin_lock_irqsave(&(ddata->irq_lock), flags);
+    stream->samples_per_irq = config.samples_per_irq;
+    stream->irq_enable = config.irq_enable;
+    stream->interrupts = 0;
+    stream->samples = 0;
+    stream->overruns = 0;
+    stream->running = true;
+    outb(stream->irq_enable, ddata->regions[2].start + ACCESIO_PCI_AI12_IRQ_CTRL);
+    spin_unlock_irqrestore(&(ddata->irq_lock), flags);
+    mutex_unlock(&(stream->lock));
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_pci_ioctl_internal_ai_stream_status(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    unsigned long flags = 0;
+    accesio_pci_ai_stream_status status;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_pci_ai_stream_status)) == 0) { return -EACCES; }
+    memset(&status, 0, sizeof(accesio_pci_ai_stream_status));
+    spin_lock_irqsave(&(ddata->irq_lock), flags);
+    status.running = ddata->ai_stream.running;
+    status.available = kfifo_len(&(ddata->ai_stream.ring));
+    status.ring_samples = kfifo_size(&(ddata->ai_stream.ring));
+    status.interrupts = ddata->ai_stream.interrupts;
+    status.samples = ddata->ai_stream.samples;
+    status.overruns = ddata->ai_stream.overruns;
+    spin_unlock_irqrestore(&(ddata->irq_lock), flags);
+    if (copy_to_user((accesio_pci_ai_stream_status*)arg, &status, sizeof(accesio_pci_ai_stream_status)) != 0) { return -EIO; }
+    return ACCESIO_SUCCESS;
+}
+
+static ssize_t accesio_pci_ai_stream_read(accesio_pci_device_info* ddata, struct file* filp, char *__user buf, size_t len)
+{
+    int ret = 0;
+    unsigned int copied = 0;
+    accesio_pci_ai_stream* stream = &ddata->ai_stream;
+    if (len < sizeof(uint16_t)) { return -EINVAL; }
+    for (;;) {
+        ret = mutex_lock_interruptible(&(stream->lock));
+        if (ret < 0) { return ret; }
+        if (!kfifo_is_empty(&(stream->ring))) {
+            ret = kfifo_to_user(&(stream->ring), buf, len, &copied);
+            mutex_unlock(&(stream->lock));
+            return ((ret != 0) ? ret : copied);
+        }
+        mutex_unlock(&(stream->lock));
+        // stopped and drained, report EOF
+        if (!stream->running) { return 0; }
+        if (filp->f_flags & O_NONBLOCK) { return -EAGAIN; }
+        ret = wait_event_interruptible(stream->wait, (!kfifo_is_empty(&(stream->ring)) || !stream->running));
+        if (ret < 0) { return ret; }
+    }
+}
+
+static bool accesio_pci_is_da12(uint32_t product_id)
+{
+    switch (product_id) {
+        case ACCESIO_PCI_DA12_16: case ACCESIO_PCI_DA12_8: case ACCESIO_PCI_DA12_6:
+        case ACCESIO_PCI_DA12_4: case ACCESIO_PCI_DA12_2:
+            return true;
+        default: break;
+    }
+    return false;
+}
+
+static enum hrtimer_restart accesio_pci_da_playback_tick(struct hrtimer* timer)
+{
+    accesio_pci_da_playback* playback = container_of(timer, accesio_pci_da_playback, timer);
+    uint16_t* frame = NULL;
+    uint32_t channel = 0;
+    uint64_t overrun = 0;
+    unsigned long flags = 0;
+    bool wake = false;
+    spin_lock_irqsave(&(playback->bank_lock), flags);
+    if (!playback->running) {
+        spin_unlock_irqrestore(&(playback->bank_lock), flags);
+        return HRTIMER_NORESTART;
+    }
+    if (playback->bank_frames[playback->current] == 0) {
+        // nothing loaded, the DACs keep their last value
+        ++playback->underruns;
+    } else {
+        frame = playback->banks[playback->current] + (playback->position * playback->channels);
+        for (channel = 0; channel < playback->channels; ++channel) {
+            accesio_pci_region_write(playback->region, playback->offset + (channel * playback->stride), ACCESIO_WORD, frame[channel]);
+        }
+        ++playback->played;
+        if (++playback->position >= playback->bank_frames[playback->current]) {
+            playback->position = 0;
+            ++playback->buffers;
+            // a looped buffer keeps playing until another one is queued behind it
+            if (!playback->loop || playback->bank_frames[playback->current ^ 1] != 0) {
+                playback->bank_frames[playback->current] = 0;
+                playback->current ^= 1;
+                wake = true;
+            }
+        }
+    }
+    overrun = hrtimer_forward_now(timer, playback->period);
+    if (overrun > 1) { playback->missed += (overrun - 1); }
+    spin_unlock_irqrestore(&(playback->bank_lock), flags);
+    if (wake) { wake_up_interruptible(&(playback->wait)); }
+    return HRTIMER_RESTART;
+}
+
+static void accesio_pci_da_playback_stop(accesio_pci_device_info* ddata)
+{
+    unsigned long flags = 0;
+    accesio_pci_da_playback* playback = &ddata->da_playback;
+    spin_lock_irqsave(&(playback->bank_lock), flags);
+    playback->running = false;
+    spin_unlock_irqrestore(&(playback->bank_lock), flags);
+    hrtimer_cancel(&(playback->timer));
+    wake_up_interruptible(&(playback->wait));
+}
+
+static void accesio_pci_da_playback_free(accesio_pci_da_playback* playback)
+{
+    vfree(playback->banks[0]);
+    vfree(playback->banks[1]);
+    playback->banks[0] = NULL;
+    playback->banks[1] = NULL;
+    playback->bank_frames[0] = 0;
+    playback->bank_frames[1] = 0;
+    playback->frames = 0;
+}
+
+static inline int accesio_pci_ioctl_internal_da_playback_setup(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    size_t samples = 0;
+    accesio_pci_da_playback_config config;
+    accesio_pci_da_playback* playback = &ddata->da_playback;
+    if (!accesio_pci_is_da12(ddata->product_id)) { return -ENOSYS; }
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_da_playback_config)) == 0) { return -EACCES; }
+    if (copy_from_user(&config, (accesio_pci_da_playback_config*)arg, sizeof(accesio_pci_da_playback_config)) != 0) { return -EIO; }
+    if (config.bar == 0) { config.bar = 3; }
+    if (config.stride == 0) { config.stride = sizeof(uint16_t); }
+    if (config.bar >= ACCESIO_MAX_REGIONS || ddata->regions[config.bar].address_type == ACCESIO_ADDR_INVALID) { return -ENXIO; }
+    if (config.channels == 0 || config.channels > ACCESIO_PCI_DA_PLAYBACK_CHANNELS_MAX) { return -EINVAL; }
+    if (config.period_ns < ACCESIO_PCI_DA_PLAYBACK_PERIOD_MIN) { return -EINVAL; }
+    if (config.frames == 0 || config.frames > (ACCESIO_PCI_DA_PLAYBACK_SAMPLES_MAX / config.channels)) { return -EINVAL; }
+    if ((config.offset + ((config.channels - 1) * config.stride) + sizeof(uint16_t)) > ddata->regions[config.bar].length) { return -EFAULT; }
+    samples = (size_t)config.frames * config.channels;
+    ret = mutex_lock_interruptible(&(playback->lock));
+    if (ret < 0) { return ret; }
+    if (playback->running) {
+        mutex_unlock(&(playback->lock));
+        return -EBUSY;
+    }
+    accesio_pci_da_playback_free(playback);
+    playback->banks[0] = vmalloc(samples * sizeof(uint16_t));
+    playback->banks[1] = vmalloc(samples * sizeof(uint16_t));
+    if (playback->banks[0] == NULL || playback->banks[1] == NULL) {
+        accesio_pci_da_playback_free(playback);
+        mutex_unlock(&(playback->lock));
+        return -ENOMEM;
+    }
+    playback->frames = config.frames;
+    playback->channels = config.channels;
+    playback->period = ns_to_ktime(config.period_ns);
+    playback->region = &(ddata->regions[config.bar]);
+    playback->offset = config.offset;
+    playback->stride = config.stride;
+    playback->loop = (config.loop != 0);
+    playback->current = 0;
+    playback->position = 0;
+    mutex_unlock(&(playback->lock));
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_pci_ioctl_internal_da_playback_load(accesio_pci_device_info* ddata, struct file* filp, unsigned long arg)
+{
+    int ret = 0;
+    uint32_t bank = 0;
+    unsigned long flags = 0;
+    accesio_pci_da_playback_buffer buffer;
+    accesio_pci_da_playback* playback = &ddata->da_playback;
+    if (!accesio_pci_is_da12(ddata->product_id)) { return -ENOSYS; }
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_da_playback_buffer)) == 0) { return -EACCES; }
+    if (copy_from_user(&buffer, (accesio_pci_da_playback_buffer*)arg, sizeof(accesio_pci_da_playback_buffer)) != 0) { return -EIO; }
+    ret = mutex_lock_interruptible(&(playback->lock));
+    if (ret < 0) { return ret; }
+    if (playback->frames == 0) { ret = -EINVAL; goto exit; }
+    if (buffer.frames == 0 || buffer.frames > playback->frames || buffer.samples == NULL) { ret = -EINVAL; goto exit; }
+    for (;;) {
+        // an idle current bank is filled first, otherwise the one queued behind it
+        spin_lock_irqsave(&(playback->bank_lock), flags);
+        if (playback->bank_frames[playback->current] == 0) {
+            bank = playback->current;
+        } else if (playback->bank_frames[playback->current ^ 1] == 0) {
+            bank = playback->current ^ 1;
+        } else {
+            bank = 2;
+        }
+        spin_unlock_irqrestore(&(playback->bank_lock), flags);
+        if (bank < 2) { break; }
+        if (!playback->running || (filp->f_flags & O_NONBLOCK)) { ret = -EAGAIN; goto exit; }
+        mutex_unlock(&(playback->lock));
+        ret = wait_event_interruptible(playback->wait, ((playback->bank_frames[0] == 0) || (playback->bank_frames[1] == 0) || !playback->running));
+        if (ret < 0) { return ret; }
+        ret = mutex_lock_interruptible(&(playback->lock));
+        if (ret < 0) { return ret; }
+        if (playback->frames == 0 || buffer.frames > playback->frames) { ret = -EINVAL; goto exit; }
+    }
+    // the timer never touches a bank with no frames, so it can be filled unlocked
+    if (copy_from_user(playback->banks[bank], buffer.samples, ((size_t)buffer.frames * playback->channels * sizeof(uint16_t))) != 0) {
+        ret = -EIO;
+        goto exit;
+    }
+    spin_lock_irqsave(&(playback->bank_lock), flags);
+    if (bank == playback->current) { playback->position = 0; }
+    playback->bank_frames[bank] = buffer.frames;
+    spin_unlock_irqrestore(&(playback->bank_lock), flags);
+exit:
+    mutex_unlock(&(playback->lock));
+    return ret;
+}
+
+static inline int accesio_pci_ioctl_internal_da_playback_start(accesio_pci_device_info* ddata)
+{
+    int ret = 0;
+    unsigned long flags = 0;
+    accesio_pci_da_playback* playback = &ddata->da_playback;
+    if (!accesio_pci_is_da12(ddata->product_id)) { return -ENOSYS; }
+    ret = mutex_lock_interruptible(&(playback->lock));
+    if (ret < 0) { return ret; }
+    if (playback->running) { ret = -EBUSY; goto exit; }
+    if (playback->bank_frames[playback->current] == 0) { ret = -EINVAL; goto exit; }
+    spin_lock_irqsave(&(playback->bank_lock), flags);
+    playback->played = 0;
+    playback->buffers = 0;
+    playback->underruns = 0;
+    playback->missed = 0;
+    playback->running = true;
+    spin_unlock_irqrestore(&(playback->bank_lock), flags);
+    hrtimer_start(&(playback->timer), playback->period, HRTIMER_MODE_REL);
+exit:
+    mutex_unlock(&(playback->lock));
+    return ret;
+}
+
+static inline int accesio_pci_ioctl_internal_da_playback_status(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    unsigned long flags = 0;
+    accesio_pci_da_playback_status status;
+    accesio_pci_da_playback* playback = &ddata->da_playback;
+    if (!accesio_pci_is_da12(ddata->product_id)) { return -ENOSYS; }
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_pci_da_playback_status)) == 0) { return -EACCES; }
+    memset(&status, 0, sizeof(accesio_pci_da_playback_status));
+    spin_lock_irqsave(&(playback->bank_lock), flags);
+    status.running = playback->running;
+    status.queued = (playback->bank_frames[0] != 0) + (playback->bank_frames[1] != 0);
+    status.position = playback->position;
+    status.frames = playback->played;
+    status.buffers = playback->buffers;
+    status.underruns = playback->underruns;
+    status.missed = playback->missed;
+    spin_unlock_irqrestore(&(playback->bank_lock), flags);
+    if (copy_to_user((accesio_pci_da_playback_status*)arg, &status, sizeof(accesio_pci_da_playback_status)) != 0) { return -EIO; }
+    return ACCESIO_SUCCESS;
+}
+
+// called with step_lock held, returns false when there is no step to apply
+static bool accesio_pci_dio_pattern_next(accesio_pci_dio_pattern* pattern, accesio_pci_dio_pattern_step* step)
+{
+    if (pattern->streaming) {
+        if (pattern->count == 0) {
+            pattern->starved = true;
+            ++pattern->underruns;
+            return false;
+        }
+        *step = pattern->steps[pattern->position];
+        pattern->position = (pattern->position + 1) % pattern->capacity;
+        --pattern->count;
+        return true;
+    }
+    if (pattern->position >= pattern->count) {
+        pattern->position = 0;
+        ++pattern->loops_done;
+        if (pattern->loops != 0 && pattern->loops_done >= pattern->loops) {
+            pattern->running = false;
+            return false;
+        }
+    }
+    *step = pattern->steps[pattern->position++];
+    return true;
+}
+
+static enum hrtimer_restart accesio_pci_dio_pattern_tick(struct hrtimer* timer)
+{
+    accesio_pci_dio_pattern* pattern = container_of(timer, accesio_pci_dio_pattern, timer);
+    accesio_pci_dio_pattern_step step;
+    enum hrtimer_restart restart = HRTIMER_RESTART;
+    unsigned long flags = 0;
+    uint32_t burst = 0;
+    uint8_t value = 0;
+    s64 late = 0;
+    spin_lock_irqsave(&(pattern->step_lock), flags);
+    if (!pattern->running) {
+        spin_unlock_irqrestore(&(pattern->step_lock), flags);
+        return HRTIMER_NORESTART;
+    }
+    late = ktime_to_ns(ktime_sub(ktime_get(), hrtimer_get_expires(timer)));
+    if (late > pattern->late_ns) { ++pattern->late; }
+    if (late > 0 && (uint64_t)late > pattern->max_late_ns) { pattern->max_late_ns = late; }
+    step.delay_ns = 0;
+    for (burst = 0; burst < ACCESIO_PCI_DIO_PATTERN_BURST_MAX; ++burst) {
+        if (!accesio_pci_dio_pattern_next(pattern, &step)) {
+            restart = HRTIMER_NORESTART;
+            break;
+        }
+        if (step.mask == 0xFF) {
+            value = step.value;
+        } else {
+            value = accesio_pci_region_read(pattern->region, step.offset, ACCESIO_BYTE);
+            value = (value & ~step.mask) | (step.value & step.mask);
+        }
+        accesio_pci_region_write(pattern->region, step.offset, ACCESIO_BYTE, value);
+        ++pattern->executed;
+        if (step.delay_ns != 0) { break; }
+    }
+    // the next step is due relative to when this one was due, not when it ran
+    if (restart == HRTIMER_RESTART) {
+        hrtimer_set_expires(timer, ktime_add_ns(hrtimer_get_expires(timer), step.delay_ns));
+    }
+    spin_unlock_irqrestore(&(pattern->step_lock), flags);
+    if (pattern->streaming || restart == HRTIMER_NORESTART) { wake_up_interruptible(&(pattern->wait)); }
+    return restart;
+}
+
+static void accesio_pci_dio_pattern_stop(accesio_pci_device_info* ddata)
+{
+    unsigned long flags = 0;
+    accesio_pci_dio_pattern* pattern = &ddata->dio_pattern;
+    spin_lock_irqsave(&(pattern->step_lock), flags);
+    pattern->running = false;
+    spin_unlock_irqrestore(&(pattern->step_lock), flags);
+    hrtimer_cancel(&(pattern->timer));
+    wake_up_interruptible(&(pattern->wait));
+}
+
+static void accesio_pci_dio_pattern_free(accesio_pci_dio_pattern* pattern)
+{
+    vfree(pattern->steps);
+    pattern->steps = NULL;
+    pattern->capacity = 0;
+    pattern->count = 0;
+    pattern->head = 0;
+    pattern->position = 0;
+}
+
+static inline int accesio_pci_ioctl_internal_dio_pattern_setup(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    accesio_pci_dio_pattern_config config;
+    accesio_pci_dio_pattern* pattern = &ddata->dio_pattern;
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_dio_pattern_config)) == 0) { return -EACCES; }
+    if (copy_from_user(&config, (accesio_pci_dio_pattern_config*)arg, sizeof(accesio_pci_dio_pattern_config)) != 0) { return -EIO; }
+    if (config.bar == 0) { config.bar = accesio_get_bar(ddata->product_id); }
+    if (config.bar >= ACCESIO_MAX_REGIONS || ddata->regions[config.bar].address_type == ACCESIO_ADDR_INVALID) { return -ENXIO; }
+    if (config.capacity == 0 || config.capacity > ACCESIO_PCI_DIO_PATTERN_STEPS_MAX) { return -EINVAL; }
+    if (config.late_ns == 0) { config.late_ns = ACCESIO_PCI_DIO_PATTERN_LATE_DEFAULT; }
+    ret = mutex_lock_interruptible(&(pattern->lock));
+    if (ret < 0) { return ret; }
+    if (pattern->running) {
+        mutex_unlock(&(pattern->lock));
+        return -EBUSY;
+    }
+    accesio_pci_dio_pattern_free(pattern);
+    pattern->steps = vmalloc(config.capacity * sizeof(accesio_pci_dio_pattern_step));
+    if (pattern->steps == NULL) {
+        mutex_unlock(&(pattern->lock));
+        return -ENOMEM;
+    }
+    pattern->capacity = config.capacity;
+    pattern->loops = config.loops;
+    pattern->late_ns = config.late_ns;
+    pattern->region = &(ddata->regions[config.bar]);
+    pattern->streaming = (config.streaming != 0);
+    mutex_unlock(&(pattern->lock));
+    return ACCESIO_SUCCESS;
+}
+
+static bool accesio_pci_dio_pattern_steps_valid(accesio_pci_dio_pattern* pattern, accesio_pci_dio_pattern_step* steps, uint32_t count)
+{
+    uint32_t i = 0;
+    bool delayed = pattern->streaming;
+    for (i = 0; i < count; ++i) {
+        if (steps[i].offset >= pattern->region->length) { return false; }
+        if (steps[i].delay_ns != 0) { delayed = true; }
+    }
+    // a looping table with no delay anywhere would never let the timer go idle
+    return delayed;
+}
+
+/* In table mode the steps replace the table, which must be stopped. When
+ * streaming, as many steps as fit are appended to the ring and the count
+ * appended is returned; with a full ring this blocks unless O_NONBLOCK. */
+static inline int accesio_pci_ioctl_internal_dio_pattern_load(accesio_pci_device_info* ddata, struct file* filp, unsigned long arg)
+{
+    int ret = 0;
+    uint32_t space = 0;
+    uint32_t first = 0;
+    unsigned long flags = 0;
+    accesio_pci_dio_pattern_steps load;
+    accesio_pci_dio_pattern_step* staged = NULL;
+    accesio_pci_dio_pattern* pattern = &ddata->dio_pattern;
+    bool kick = false;
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_dio_pattern_steps)) == 0) { return -EACCES; }
+    if (copy_from_user(&load, (accesio_pci_dio_pattern_steps*)arg, sizeof(accesio_pci_dio_pattern_steps)) != 0) { return -EIO; }
+    if (load.count == 0 || load.steps == NULL) { return -EINVAL; }
+    ret = mutex_lock_interruptible(&(pattern->lock));
+    if (ret < 0) { return ret; }
+    if (pattern->capacity == 0 || load.count > pattern->capacity) { ret = -EINVAL; goto exit; }
+    if (!pattern->streaming) {
+        if (pattern->running) { ret = -EBUSY; goto exit; }
+        pattern->count = 0;
+        if (copy_from_user(pattern->steps, load.steps, (load.count * sizeof(accesio_pci_dio_pattern_step))) != 0) { ret = -EIO; goto exit; }
+        if (!accesio_pci_dio_pattern_steps_valid(pattern, pattern->steps, load.count)) { ret = -EINVAL; goto exit; }
+        pattern->count = load.count;
+        pattern->position = 0;
+        goto exit;
+    }
+    for (;;) {
+        spin_lock_irqsave(&(pattern->step_lock), flags);
+        space = pattern->capacity - pattern->count;
+        spin_unlock_irqrestore(&(pattern->step_lock), flags);
+        if (space != 0) { break; }
+        if (!pattern->running || (filp->f_flags & O_NONBLOCK)) { ret = -EAGAIN; goto exit; }
+        mutex_unlock(&(pattern->lock));
+        ret = wait_event_interruptible(pattern->wait, ((pattern->count < pattern->capacity) || !pattern->running));
+        if (ret < 0) { return ret; }
+        ret = mutex_lock_interruptible(&(pattern->lock));
+        if (ret < 0) { return ret; }
+        if (!pattern->streaming || pattern->capacity == 0) { ret = -EINVAL; goto exit; }
+    }
+    if (load.count > space) { load.count = space; }
+    // the timer consumes from the ring, so the steps are staged and checked first
+    staged = vmalloc(load.count * sizeof(accesio_pci_dio_pattern_step));
+    if (staged == NULL) { ret = -ENOMEM; goto exit; }
+    if (copy_from_user(staged, load.steps, (load.count * sizeof(accesio_pci_dio_pattern_step))) != 0) { ret = -EIO; goto exit; }
+    if (!accesio_pci_dio_pattern_steps_valid(pattern, staged, load.count)) { ret = -EINVAL; goto exit; }
+    // only the appender moves head, so the copy into free slots can be unlocked
+    first = min(load.count, (pattern->capacity - pattern->head));
+    memcpy(&(pattern->steps[pattern->head]), staged, (first * sizeof(accesio_pci_dio_pattern_step)));
+    memcpy(pattern->steps, &(staged[first]), ((load.count - first) * sizeof(accesio_pci_dio_pattern_step)));
+    spin_lock_irqsave(&(pattern->step_lock), flags);
+    pattern->head = (pattern->head + load.count) % pattern->capacity;
+    pattern->count += load.count;
+    if (pattern->running && pattern->starved) {
+        pattern->starved = false;
+        kick = true;
+    }
+    spin_unlock_irqrestore(&(pattern->step_lock), flags);
+    if (kick) { hrtimer_start(&(pattern->timer), ktime_get(), HRTIMER_MODE_ABS); }
+    ret = load.count;
+exit:
+    vfree(staged);
+    mutex_unlock(&(pattern->lock));
+    return ret;
+}
+
+static inline int accesio_pci_ioctl_internal_dio_pattern_start(accesio_pci_device_info* ddata)
+{
+    int ret = 0;
+    unsigned long flags = 0;
+    accesio_pci_dio_pattern* pattern = &ddata->dio_pattern;
+    ret = mutex_lock_interruptible(&(pattern->lock));
+    if (ret < 0) { return ret; }
+    if (pattern->running) { ret = -EBUSY; goto exit; }
+    if (pattern->capacity == 0 || pattern->count == 0) { ret = -EINVAL; goto exit; }
+    // the timer may still be finishing the expiry that ended the last run
+    hrtimer_cancel(&(pattern->timer));
+    spin_lock_irqsave(&(pattern->step_lock), flags);
+    if (!pattern->streaming) { pattern->position = 0; }
+    pattern->executed = 0;
+    pattern->loops_done = 0;
+    pattern->underruns = 0;
+    pattern->late = 0;
+    pattern->max_late_ns = 0;
+    pattern->starved = false;
+    pattern->running = true;
+    spin_unlock_irqrestore(&(pattern->step_lock), flags);
+    hrtimer_start(&(pattern->timer), ktime_get(), HRTIMER_MODE_ABS);
+exit:
+    mutex_unlock(&(pattern->lock));
+    return ret;
+}
+
+static inline int accesio_pci_ioctl_internal_dio_pattern_status(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    unsigned long flags = 0;
+    accesio_pci_dio_pattern_status status;
+    accesio_pci_dio_pattern* pattern = &ddata->dio_pattern;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_pci_dio_pattern_status)) == 0) { return -EACCES; }
+    memset(&status, 0, sizeof(accesio_pci_dio_pattern_status));
+    spin_lock_irqsave(&(pattern->step_lock), flags);
+    status.running = pattern->running;
+    status.streaming = pattern->streaming;
+    status.count = pattern->count;
+    status.position = pattern->position;
+    status.steps = pattern->executed;
+    status.loops = pattern->loops_done;
+    status.underruns = pattern->underruns;
+    status.late = pattern->late;
+    status.max_late_ns = pattern->max_late_ns;
+    spin_unlock_irqrestore(&(pattern->step_lock), flags);
+    if (copy_to_user((accesio_pci_dio_pattern_status*)arg, &status, sizeof(accesio_pci_dio_pattern_status)) != 0) { return -EIO; }
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_pci_ioctl_internal_group_bind(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    uint32_t i = 0;
+    uint32_t j = 0;
+    accesio_pci_group_config config;
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_group_config)) == 0) { return -EACCES; }
+    if (copy_from_user(&config, (accesio_pci_group_config*)arg, sizeof(accesio_pci_group_config)) != 0) { return -EIO; }
+    if (config.count > ACCESIO_PCI_GROUP_MAX) { return -EINVAL; }
+    for (i = 0; i < config.count; ++i) {
+        if (config.device_index[i] >= ACCESIO_PCI_MAX_CARDS) { return -ENODEV; }
+        for (j = 0; j < i; ++j) {
+            if (config.device_index[i] == config.device_index[j]) { return -EINVAL; }
+        }
+    }
+    mutex_lock(&accesio_pci_devices_lock);
+    for (i = 0; i < config.count; ++i) {
+        if (accesio_pci_devices[config.device_index[i]] == NULL) {
+            mutex_unlock(&accesio_pci_devices_lock);
+            return -ENODEV;
+        }
+    }
+    ddata->group.count = config.count;
+    memcpy(ddata->group.device_index, config.device_index, sizeof(config.device_index));
+    mutex_unlock(&accesio_pci_devices_lock);
+    return ACCESIO_SUCCESS;
+}
+
+/* Runs every entry of the transfer in one pass with local interrupts off so
+ * the accesses across the member cards land as close together as possible.
+ * Members are looked up by index each time, a removed card fails with -ENODEV. */
+static inline int accesio_pci_ioctl_internal_group_transfer(accesio_pci_device_info* ddata, unsigned long arg, bool write)
+{
+    int ret = ACCESIO_SUCCESS;
+    uint32_t i = 0;
+    uint64_t start = 0;
+    unsigned long flags = 0;
+    accesio_pci_group_transfer transfer;
+    accesio_pci_group_io* entries = NULL;
+    accesio_pci_region** regions = NULL;
+    accesio_pci_device_info* member = NULL;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_pci_group_transfer)) == 0) { return -EACCES; }
+    if (copy_from_user(&transfer, (accesio_pci_group_transfer*)arg, sizeof(accesio_pci_group_transfer)) != 0) { return -EIO; }
+    if (transfer.count == 0 || transfer.count > ACCESIO_PCI_GROUP_IO_MAX || transfer.entries == NULL) { return -EINVAL; }
+    entries = kmalloc_array(transfer.count, sizeof(accesio_pci_group_io), GFP_KERNEL);
+    regions = kmalloc_array(transfer.count, sizeof(accesio_pci_region*), GFP_KERNEL);
+    if (entries == NULL || regions == NULL) { ret = -ENOMEM; goto exit; }
+    if (copy_from_user(entries, transfer.entries, (transfer.count * sizeof(accesio_pci_group_io))) != 0) { ret = -EIO; goto exit; }
+    mutex_lock(&accesio_pci_devices_lock);
+    // resolve and check everything first, nothing may fail once interrupts are off
+    for (i = 0; i < transfer.count; ++i) {
+        if (entries[i].member >= ddata->group.count) { ret = -EINVAL; break; }
+        member = accesio_pci_devices[ddata->group.device_index[entries[i].member]];
+        if (member == NULL) { ret = -ENODEV; break; }
+        if (entries[i].bar == 0) { entries[i].bar = accesio_get_bar(member->product_id); }
+        if (entries[i].bar >= ACCESIO_MAX_REGIONS || member->regions[entries[i].bar].address_type == ACCESIO_ADDR_INVALID) { ret = -ENXIO; break; }
+        if (entries[i].size != ACCESIO_BYTE && entries[i].size != ACCESIO_WORD && entries[i].size != ACCESIO_DWORD) { ret = -EINVAL; break; }
+        if ((entries[i].offset + entries[i].size) > member->regions[entries[i].bar].length) { ret = -EFAULT; break; }
+        regions[i] = &(member->regions[entries[i].bar]);
+    }
+    if (ret != ACCESIO_SUCCESS) {
+        mutex_unlock(&accesio_pci_devices_lock);
+        goto exit;
+    }
+    local_irq_save(flags);
+    start = ktime_get_ns();
+    for (i = 0; i < transfer.count; ++i) {
+        if (write) {
+            accesio_pci_region_write(regions[i], entries[i].offset, entries[i].size, entries[i].data);
+        } else {
+            entries[i].data = accesio_pci_region_read(regions[i], entries[i].offset, entries[i].size);
+        }
+    }
+    transfer.span_ns = ktime_get_ns() - start;
+    local_irq_restore(flags);
+    mutex_unlock(&accesio_pci_devices_lock);
+    transfer.timestamp_ns = start;
+    if (!write && copy_to_user(transfer.entries, entries, (transfer.count * sizeof(accesio_pci_group_io))) != 0) { ret = -EIO; goto exit; }
+    if (copy_to_user((accesio_pci_group_transfer*)arg, &transfer, sizeof(accesio_pci_group_transfer)) != 0) { ret = -EIO; }
+exit:
+    kfree(regions);
+    kfree(entries);
+    return ret;
+}
+
+static bool accesio_pci_is_wdg(uint32_t product_id)
+{
+    switch (product_id) {
+        case ACCESIO_PCI_WDG_2S: case ACCESIO_PCI_WDG_CSM: case ACCESIO_PCI_WDG_IMPAC:
+            return true;
+        default: break;
+    }
+    return false;
+}
+
+static enum hrtimer_restart accesio_pci_wdg_service_tick(struct hrtimer* timer)
+{
+    accesio_pci_wdg_service* service = container_of(timer, accesio_pci_wdg_service, timer);
+    unsigned long flags = 0;
+    ktime_t now = ktime_get();
+    s64 late = ktime_to_ns(ktime_sub(now, hrtimer_get_expires(timer)));
+    spin_lock_irqsave(&(service->lock), flags);
+    if (!service->running) {
+        spin_unlock_irqrestore(&(service->lock), flags);
+        return HRTIMER_NORESTART;
+    }
+    if (late > 0 && (uint64_t)late > service->max_kick_late_ns) { service->max_kick_late_ns = late; }
+    // without a recent heartbeat the application is presumed hung, let the watchdog fire
+    if ((uint64_t)ktime_to_ns(ktime_sub(now, service->last_heartbeat)) > service->liveness_ns) {
+        if (!service->withheld) {
+            service->withheld = true;
+            ++service->lapses;
+        }
+    } else {
+        if (service->read) {
+            accesio_pci_region_read(service->region, service->offset, service->size);
+        } else {
+            accesio_pci_region_write(service->region, service->offset, service->size, service->value);
+        }
+        ++service->kicks;
+    }
+    hrtimer_forward(timer, now, service->period);
+    spin_unlock_irqrestore(&(service->lock), flags);
+    return HRTIMER_RESTART;
+}
+
+static void accesio_pci_wdg_service_stop(accesio_pci_device_info* ddata)
+{
+    unsigned long flags = 0;
+    spin_lock_irqsave(&(ddata->wdg_service.lock), flags);
+    ddata->wdg_service.running = false;
+    spin_unlock_irqrestore(&(ddata->wdg_service.lock), flags);
+    hrtimer_cancel(&(ddata->wdg_service.timer));
+}
+
+static inline int accesio_pci_ioctl_internal_wdg_service_start(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    unsigned long flags = 0;
+    accesio_pci_wdg_service_config config;
+    accesio_pci_wdg_service* service = &ddata->wdg_service;
+    if (!accesio_pci_is_wdg(ddata->product_id)) { return -ENOSYS; }
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_wdg_service_config)) == 0) { return -EACCES; }
+    if (copy_from_user(&config, (accesio_pci_wdg_service_config*)arg, sizeof(accesio_pci_wdg_service_config)) != 0) { return -EIO; }
+    if (config.bar == 0) { config.bar = accesio_get_bar(ddata->product_id); }
+    if (config.bar >= ACCESIO_MAX_REGIONS || ddata->regions[config.bar].address_type == ACCESIO_ADDR_INVALID) { return -ENXIO; }
+    if (config.size != ACCESIO_BYTE && config.size != ACCESIO_WORD && config.size != ACCESIO_DWORD) { return -EINVAL; }
+    if ((config.offset + config.size) > ddata->regions[config.bar].length) { return -EFAULT; }
+    if (config.period_ns < ACCESIO_PCI_WDG_SERVICE_PERIOD_MIN || config.liveness_ns == 0) { return -EINVAL; }
+    // restarting replaces the configuration, the stats start over
+    accesio_pci_wdg_service_stop(ddata);
+    spin_lock_irqsave(&(service->lock), flags);
+    service->region = &(ddata->regions[config.bar]);
+    service->period = ns_to_ktime(config.period_ns);
+    service->liveness_ns = config.liveness_ns;
+    service->value = config.value;
+    service->offset = config.offset;
+    service->size = config.size;
+    service->read = (config.read != 0);
+    service->last_heartbeat = ktime_get();
+    service->withheld = false;
+    service->kicks = 0;
+    service->heartbeats = 0;
+    service->lapses = 0;
+    service->min_heartbeat_margin_ns = config.liveness_ns;
+    service->max_kick_late_ns = 0;
+    service->running = true;
+    spin_unlock_irqrestore(&(service->lock), flags);
+    // kick straight away so the watchdog starts from a full period
+    hrtimer_start(&(service->timer), ns_to_ktime(0), HRTIMER_MODE_REL);
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_pci_ioctl_internal_wdg_heartbeat(accesio_pci_device_info* ddata)
+{
+    unsigned long flags = 0;
+    s64 margin = 0;
+    ktime_t now = ktime_get();
+    accesio_pci_wdg_service* service = &ddata->wdg_service;
+    if (!accesio_pci_is_wdg(ddata->product_id)) { return -ENOSYS; }
+    spin_lock_irqsave(&(service->lock), flags);
+    if (!service->running) {
+        spin_unlock_irqrestore(&(service->lock), flags);
+        return -EINVAL;
+    }
+    margin = (s64)service->liveness_ns - ktime_to_ns(ktime_sub(now, service->last_heartbeat));
+    if (margin < 0) { margin = 0; }
+    if ((uint64_t)margin < service->min_heartbeat_margin_ns) { service->min_heartbeat_margin_ns = margin; }
+    service->last_heartbeat = now;
+    service->withheld = false;
+    ++service->heartbeats;
+    spin_unlock_irqrestore(&(service->lock), flags);
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_pci_ioctl_internal_wdg_service_status(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    unsigned long flags = 0;
+    accesio_pci_wdg_service_status status;
+    accesio_pci_wdg_service* service = &ddata->wdg_service;
+    if (!accesio_pci_is_wdg(ddata->product_id)) { return -ENOSYS; }
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_pci_wdg_service_status)) == 0) { return -EACCES; }
+    memset(&status, 0, sizeof(accesio_pci_wdg_service_status));
+    spin_lock_irqsave(&(service->lock), flags);
+    status.running = service->running;
+    status.withheld = service->withheld;
+    status.kicks = service->kicks;
+    status.heartbeats = service->heartbeats;
+    status.lapses = service->lapses;
+    status.min_heartbeat_margin_ns = service->min_heartbeat_margin_ns;
+    status.max_kick_late_ns = service->max_kick_late_ns;
+    spin_unlock_irqrestore(&(service->lock), flags);
+    if (copy_to_user((accesio_pci_wdg_service_status*)arg, &status, sizeof(accesio_pci_wdg_service_status)) != 0) { return -EIO; }
+    return ACCESIO_SUCCESS;
+}
+
+static bool accesio_pci_is_iiro(uint32_t product_id)
+{
+    switch (product_id) {
+        case ACCESIO_PCIE_IIRO_8: case ACCESIO_PCIE_IIRO_16: case ACCESIO_PCI_IIRO_8:
+        case ACCESIO_PCI_IIRO_16: case ACCESIO_PCI_IDIO_16: case ACCESIO_LPCI_IIRO_8:
+            return true;
+        default: break;
+    }
+    return false;
+}
+
+// called from the COS interrupt, returns true if the filter took the event
+static bool accesio_pci_debounce_cos(accesio_pci_device_info* ddata)
+{
+    accesio_pci_debounce* debounce = &ddata->debounce;
+    spin_lock(&(debounce->state_lock));
+    if (!debounce->running) {
+        spin_unlock(&(debounce->state_lock));
+        return false;
+    }
+    ++debounce->interrupts;
+    if (debounce->idle) {
+        debounce->idle = false;
+        hrtimer_start(&(debounce->timer), ns_to_ktime(0), HRTIMER_MODE_REL);
+    }
+    spin_unlock(&(debounce->state_lock));
+    return true;
+}
+
+static enum hrtimer_restart accesio_pci_debounce_tick(struct hrtimer* timer)
+{
+    accesio_pci_debounce* debounce = container_of(timer, accesio_pci_debounce, timer);
+    accesio_pci_device_info* ddata = container_of(debounce, accesio_pci_device_info, debounce);
+    accesio_pci_debounce_port* port = NULL;
+    accesio_pci_debounce_event event;
+    enum hrtimer_restart restart = HRTIMER_RESTART;
+    unsigned long flags = 0;
+    ktime_t now = ktime_get();
+    uint8_t changed = 0;
+    uint8_t accepted = 0;
+    uint8_t raw = 0;
+    uint8_t p = 0;
+    uint8_t bit = 0;
+    bool settled = true;
+    bool wake = false;
+    spin_lock_irqsave(&(debounce->state_lock), flags);
+    if (!debounce->running) {
+        spin_unlock_irqrestore(&(debounce->state_lock), flags);
+        return HRTIMER_NORESTART;
+    }
+    ++debounce->samples;
+    for (p = 0; p < debounce->ports; ++p) {
+        port = &(debounce->port[p]);
+        raw = accesio_pci_region_read(debounce->region, port->offset, ACCESIO_BYTE);
+        changed = raw ^ port->raw;
+        port->raw = raw;
+        accepted = 0;
+        // the padding reaches user space through the event queue
+        memset(&event, 0, sizeof(accesio_pci_debounce_event));
+        for (bit = 0; bit < 8; ++bit) {
+            if (changed & (1 << bit)) {
+                port->changed_at[bit] = now;
+                ++debounce->bounces;
+            }
+            if (((port->raw ^ port->value) & (1 << bit)) == 0) { continue; }
+            if ((uint64_t)ktime_to_ns(ktime_sub(now, port->changed_at[bit])) < port->stable_ns) {
+                settled = false;
+                continue;
+            }
+            accepted |= (1 << bit);
+            if ((uint64_t)ktime_to_ns(port->changed_at[bit]) > event.timestamp_ns) {
+                event.timestamp_ns = ktime_to_ns(port->changed_at[bit]);
+            }
+        }
+        if (accepted != 0) {
+            port->value ^= accepted;
+            event.port = p;
+            event.value = port->value;
+            event.changed = accepted;
+            if (kfifo_in(&(debounce->events), &event, 1) == 0) { ++debounce->dropped; }
+            ++debounce->transitions;
+            wake = true;
+        }
+    }
+    // with a COS interrupt to restart it the sampler can sleep once everything is stable
+    if (settled && ddata->irq_capable) {
+        debounce->idle = true;
+        restart = HRTIMER_NORESTART;
+    } else {
+        hrtimer_forward(timer, now, debounce->period);
+    }
+    spin_unlock_irqrestore(&(debounce->state_lock), flags);
+    if (wake) {
+        wake_up_interruptible(&(debounce->wait));
+        accesio_pci_interrupt_irq_lock(ddata);
+    }
+    return restart;
+}
+
+static void accesio_pci_debounce_stop(accesio_pci_device_info* ddata)
+{
+    unsigned long flags = 0;
+    spin_lock_irqsave(&(ddata->debounce.state_lock), flags);
+    ddata->debounce.running = false;
+    spin_unlock_irqrestore(&(ddata->debounce.state_lock), flags);
+    hrtimer_cancel(&(ddata->debounce.timer));
+    wake_up_interruptible(&(ddata->debounce.wait));
+}
+
+static inline int accesio_pci_ioctl_internal_debounce_start(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    uint8_t p = 0;
+    uint8_t bit = 0;
+    unsigned long flags = 0;
+    ktime_t now;
+    accesio_pci_debounce_config config;
+    accesio_pci_debounce* debounce = &ddata->debounce;
+    if (!accesio_pci_is_iiro(ddata->product_id)) { return -ENOSYS; }
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_debounce_config)) == 0) { return -EACCES; }
+    if (copy_from_user(&config, (accesio_pci_debounce_config*)arg, sizeof(accesio_pci_debounce_config)) != 0) { return -EIO; }
+    if (config.bar == 0) { config.bar = accesio_get_bar(ddata->product_id); }
+    if (config.bar >= ACCESIO_MAX_REGIONS || ddata->regions[config.bar].address_type == ACCESIO_ADDR_INVALID) { return -ENXIO; }
+    if (config.ports == 0 || config.ports > ACCESIO_PCI_DEBOUNCE_PORTS) { return -EINVAL; }
+    if (config.sample_ns < ACCESIO_PCI_DEBOUNCE_SAMPLE_MIN) { return -EINVAL; }
+    if (config.queue_events == 0) { config.queue_events = ACCESIO_PCI_DEBOUNCE_EVENTS_DEFAULT; }
+    if (config.queue_events > ACCESIO_PCI_DEBOUNCE_EVENTS_MAX) { return -EINVAL; }
+    for (p = 0; p < config.ports; ++p) {
+        if (config.offset[p] >= ddata->regions[config.bar].length) { return -EFAULT; }
+    }
+    ret = mutex_lock_interruptible(&(debounce->lock));
+    if (ret < 0) { return ret; }
+    accesio_pci_debounce_stop(ddata);
+    kfifo_free(&(debounce->events));
+    ret = kfifo_alloc(&(debounce->events), config.queue_events, GFP_KERNEL);
+    if (ret != 0) {
+        mutex_unlock(&(debounce->lock));
+        return ret;
+    }
+    spin_lock_irqsave(&(debounce->state_lock), flags);
+    debounce->region = &(ddata->regions[config.bar]);
+    debounce->period = ns_to_ktime(config.sample_ns);
+    debounce->ports = config.ports;
+    now = ktime_get();
+    // the current levels are taken as already stable
+    for (p = 0; p < config.ports; ++p) {
+        debounce->port[p].offset = config.offset[p];
+        debounce->port[p].stable_ns = config.stable_ns[p];
+        debounce->port[p].raw = accesio_pci_region_read(debounce->region, config.offset[p], ACCESIO_BYTE);
+        debounce->port[p].value = debounce->port[p].raw;
+        for (bit = 0; bit < 8; ++bit) { debounce->port[p].changed_at[bit] = now; }
+    }
+    debounce->samples = 0;
+    debounce->bounces = 0;
+    debounce->transitions = 0;
+    debounce->interrupts = 0;
+    debounce->dropped = 0;
+    debounce->idle = ddata->irq_capable;
+    debounce->running = true;
+    spin_unlock_irqrestore(&(debounce->state_lock), flags);
+    if (!ddata->irq_capable) {
+        hrtimer_start(&(debounce->timer), debounce->period, HRTIMER_MODE_REL);
+    }
+    mutex_unlock(&(debounce->lock));
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_pci_ioctl_internal_debounce_events(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    unsigned int count = 0;
+    unsigned long flags = 0;
+    accesio_pci_debounce_events request;
+    accesio_pci_debounce_event* events = NULL;
+    accesio_pci_debounce* debounce = &ddata->debounce;
+    if (!accesio_pci_is_iiro(ddata->product_id)) { return -ENOSYS; }
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_debounce_events)) == 0) { return -EACCES; }
+    if (copy_from_user(&request, (accesio_pci_debounce_events*)arg, sizeof(accesio_pci_debounce_events)) != 0) { return -EIO; }
+    if (request.count == 0 || request.events == NULL) { return -EINVAL; }
+    ret = mutex_lock_interruptible(&(debounce->lock));
+    if (ret < 0) { return ret; }
+    count = min(request.count, kfifo_size(&(debounce->events)));
+    if (count == 0) { goto exit; }
+    events = kmalloc_array(count, sizeof(accesio_pci_debounce_event), GFP_KERNEL);
+    if (events == NULL) { ret = -ENOMEM; goto exit; }
+    // the queue is filled from the timer, so it is drained under the lock into a bounce buffer
+    spin_lock_irqsave(&(debounce->state_lock), flags);
+    count = kfifo_out(&(debounce->events), events, count);
+    spin_unlock_irqrestore(&(debounce->state_lock), flags);
+    if (count != 0 && copy_to_user(request.events, events, (count * sizeof(accesio_pci_debounce_event))) != 0) { ret = -EIO; goto exit; }
+    ret = count;
+exit:
+    kfree(events);
+    mutex_unlock(&(debounce->lock));
+    return ret;
+}
+
+static inline int accesio_pci_ioctl_internal_debounce_status(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    uint8_t p = 0;
+    unsigned long flags = 0;
+    accesio_pci_debounce_status status;
+    accesio_pci_debounce* debounce = &ddata->debounce;
+    if (!accesio_pci_is_iiro(ddata->product_id)) { return -ENOSYS; }
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_pci_debounce_status)) == 0) { return -EACCES; }
+    memset(&status, 0, sizeof(accesio_pci_debounce_status));
+    spin_lock_irqsave(&(debounce->state_lock), flags);
+    status.running = debounce->running;
+    status.ports = debounce->ports;
+    for (p = 0; p < debounce->ports; ++p) { status.values[p] = debounce->port[p].value; }
+    status.queued = kfifo_len(&(debounce->events));
+    status.samples = debounce->samples;
+    status.bounces = debounce->bounces;
+    status.transitions = debounce->transitions;
+    status.interrupts = debounce->interrupts;
+    status.dropped = debounce->dropped;
+    spin_unlock_irqrestore(&(debounce->state_lock), flags);
+    if (copy_to_user((accesio_pci_debounce_status*)arg, &status, sizeof(accesio_pci_debounce_status)) != 0) { return -EIO; }
+    return ACCESIO_SUCCESS;
+}
+
+static bool accesio_pci_has_8254(uint32_t product_id)
+{
+    switch (product_id) {
+        case ACCESIO_PCI_DIO_24H_C: case ACCESIO_PCI_DIO_24D_C: case ACCESIO_PCI_DIO_96CT: case ACCESIO_PCI_DIO_96C3:
+            return true;
+        default: break;
+    }
+    return false;
+}
+
+static int accesio_pci_counter_validate(accesio_pci_device_info* ddata, accesio_pci_counter_config* config)
+{
+    uint8_t chip = 0;
+    if (config->bar == 0) { config->bar = accesio_get_bar(ddata->product_id); }
+    if (config->bar >= ACCESIO_MAX_REGIONS || ddata->regions[config->bar].address_type == ACCESIO_ADDR_INVALID) { return -ENXIO; }
+    if (config->chips == 0 || config->chips > ACCESIO_PCI_COUNTER_CHIPS) { return -EINVAL; }
+    for (chip = 0; chip < config->chips; ++chip) {
+        if (config->mask[chip] == 0 || (config->mask[chip] & ~0x07) != 0) { return -EINVAL; }
+        if ((config->chip_offset[chip] + ACCESIO_PCI_8254_CONTROL) >= ddata->regions[config->bar].length) { return -EFAULT; }
+    }
+    return ACCESIO_SUCCESS;
+}
+
+/* Latches every selected counter with one read-back command per chip, then
+ * reads each latched value LSB first. Called with latch_lock held. */
+static void accesio_pci_counter_latch(accesio_pci_region* region, accesio_pci_counter_config* config, accesio_pci_counter_sample* sample)
+{
+    uint8_t chip = 0;
+    uint8_t counter = 0;
+    uint16_t offset = 0;
+    memset(sample, 0, sizeof(accesio_pci_counter_sample));
+    sample->timestamp_ns = ktime_get_ns();
+    for (chip = 0; chip < config->chips; ++chip) {
+        accesio_pci_region_write(region, config->chip_offset[chip] + ACCESIO_PCI_8254_CONTROL, ACCESIO_BYTE,
+                                 ACCESIO_PCI_8254_READBACK_COUNT | (config->mask[chip] << 1));
+    }
+    for (chip = 0; chip < config->chips; ++chip) {
+        for (counter = 0; counter < 3; ++counter) {
+            if ((config->mask[chip] & (1 << counter)) == 0) { continue; }
+            offset = config->chip_offset[chip] + counter;
+            sample->counts[chip][counter] = accesio_pci_region_read(region, offset, ACCESIO_BYTE);
+            sample->counts[chip][counter] |= (accesio_pci_region_read(region, offset, ACCESIO_BYTE) << 8);
+        }
+    }
+}
+
+static enum hrtimer_restart accesio_pci_counter_tick(struct hrtimer* timer)
+{
+    accesio_pci_counter* counter = container_of(timer, accesio_pci_counter, timer);
+    accesio_pci_counter_sample sample;
+    unsigned long flags = 0;
+    spin_lock_irqsave(&(counter->latch_lock), flags);
+    if (!counter->running) {
+        spin_unlock_irqrestore(&(counter->latch_lock), flags);
+        return HRTIMER_NORESTART;
+    }
+    accesio_pci_counter_latch(counter->region, &(counter->config), &sample);
+    if (kfifo_in(&(counter->samples), &sample, 1) == 0) { ++counter->dropped; }
+    hrtimer_forward_now(timer, counter->period);
+    spin_unlock_irqrestore(&(counter->latch_lock), flags);
+    wake_up_interruptible(&(counter->wait));
+    return HRTIMER_RESTART;
+}
+
+static void accesio_pci_counter_stop(accesio_pci_device_info* ddata)
+{
+    unsigned long flags = 0;
+    spin_lock_irqsave(&(ddata->counter.latch_lock), flags);
+    ddata->counter.running = false;
+    spin_unlock_irqrestore(&(ddata->counter.latch_lock), flags);
+    hrtimer_cancel(&(ddata->counter.timer));
+    wake_up_interruptible(&(ddata->counter.wait));
+}
+
+static inline int accesio_pci_ioctl_internal_counter_capture(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    unsigned long flags = 0;
+    accesio_pci_counter_capture capture;
+    if (!accesio_pci_has_8254(ddata->product_id)) { return -ENOSYS; }
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_pci_counter_capture)) == 0) { return -EACCES; }
+    if (copy_from_user(&capture, (accesio_pci_counter_capture*)arg, sizeof(accesio_pci_counter_capture)) != 0) { return -EIO; }
+    ret = accesio_pci_counter_validate(ddata, &(capture.config));
+    if (ret != ACCESIO_SUCCESS) { return ret; }
+    spin_lock_irqsave(&(ddata->counter.latch_lock), flags);
+    accesio_pci_counter_latch(&(ddata->regions[capture.config.bar]), &(capture.config), &(capture.sample));
+    spin_unlock_irqrestore(&(ddata->counter.latch_lock), flags);
+    if (copy_to_user((accesio_pci_counter_capture*)arg, &capture, sizeof(accesio_pci_counter_capture)) != 0) { return -EIO; }
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_pci_ioctl_internal_counter_periodic_start(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    unsigned long flags = 0;
+    accesio_pci_counter_periodic periodic;
+    accesio_pci_counter* counter = &ddata->counter;
+    if (!accesio_pci_has_8254(ddata->product_id)) { return -ENOSYS; }
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_counter_periodic)) == 0) { return -EACCES; }
+    if (copy_from_user(&periodic, (accesio_pci_counter_periodic*)arg, sizeof(accesio_pci_counter_periodic)) != 0) { return -EIO; }
+    ret = accesio_pci_counter_validate(ddata, &(periodic.config));
+    if (ret != ACCESIO_SUCCESS) { return ret; }
+    if (periodic.period_ns < ACCESIO_PCI_COUNTER_PERIOD_MIN) { return -EINVAL; }
+    if (periodic.queue_samples == 0) { periodic.queue_samples = ACCESIO_PCI_COUNTER_QUEUE_DEFAULT; }
+    if (periodic.queue_samples > ACCESIO_PCI_COUNTER_QUEUE_MAX) { return -EINVAL; }
+    ret = mutex_lock_interruptible(&(counter->lock));
+    if (ret < 0) { return ret; }
+    accesio_pci_counter_stop(ddata);
+    kfifo_free(&(counter->samples));
+    ret = kfifo_alloc(&(counter->samples), periodic.queue_samples, GFP_KERNEL);
+    if (ret != 0) {
+        mutex_unlock(&(counter->lock));
+        return ret;
+    }
+    spin_lock_irqsave(&(counter->latch_lock), flags);
+    counter->config = periodic.config;
+    counter->region = &(ddata->regions[periodic.config.bar]);
+    counter->period = ns_to_ktime(periodic.period_ns);
+    counter->dropped = 0;
+    counter->running = true;
+    spin_unlock_irqrestore(&(counter->latch_lock), flags);
+    hrtimer_start(&(counter->timer), counter->period, HRTIMER_MODE_REL);
+    mutex_unlock(&(counter->lock));
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_pci_ioctl_internal_counter_read(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    unsigned int count = 0;
+    unsigned long flags = 0;
+    accesio_pci_counter_samples request;
+    accesio_pci_counter_sample* samples = NULL;
+    accesio_pci_counter* counter = &ddata->counter;
+    if (!accesio_pci_has_8254(ddata->product_id)) { return -ENOSYS; }
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_pci_counter_samples)) == 0) { return -EACCES; }
+    if (copy_from_user(&request, (accesio_pci_counter_samples*)arg, sizeof(accesio_pci_counter_samples)) != 0) { return -EIO; }
+    if (request.count == 0 || request.samples == NULL) { return -EINVAL; }
+    ret = mutex_lock_interruptible(&(counter->lock));
+    if (ret < 0) { return ret; }
+    count = min(request.count, kfifo_size(&(counter->samples)));
+    if (count != 0) {
+        samples = kmalloc_array(count, sizeof(accesio_pci_counter_sample), GFP_KERNEL);
+        if (samples == NULL) { ret = -ENOMEM; goto exit; }
+    }
+    spin_lock_irqsave(&(counter->latch_lock), flags);
+    if (count != 0) { count = kfifo_out(&(counter->samples), samples, count); }
+    request.dropped = counter->dropped;
+    spin_unlock_irqrestore(&(counter->latch_lock), flags);
+    if (count != 0 && copy_to_user(request.samples, samples, (count * sizeof(accesio_pci_counter_sample))) != 0) { ret = -EIO; goto exit; }
+    if (copy_to_user((accesio_pci_counter_samples*)arg, &request, sizeof(accesio_pci_counter_samples)) != 0) { ret = -EIO; goto exit; }
+    ret = count;
+exit:
+    kfree(samples);
+    mutex_unlock(&(counter->lock));
+    return ret;
+}
+
+static inline bool accesio_pci_bitbang_pin_valid(accesio_pci_region* region, accesio_pci_bitbang_pin* pin)
+{
+    return (pin->bit < 8 && pin->offset < region->length);
+}
+
+/* Binds an output line to a register image, lines on the same register share
+ * one image so updating one does not undo the others. */
+static void accesio_pci_bitbang_bind(accesio_pci_region* region, accesio_pci_bitbang_pin* pin, accesio_pci_bitbang_line* line,
+                                     accesio_pci_bitbang_line** bound, uint8_t bound_count, uint8_t* shadow)
+{
+    uint8_t i = 0;
+    line->offset = pin->offset;
+    line->mask = (1 << pin->bit);
+    for (i = 0; i < bound_count; ++i) {
+        if (bound[i]->offset == pin->offset) {
+            line->shadow = bound[i]->shadow;
+            return;
+        }
+    }
+    *shadow = accesio_pci_region_read(region, pin->offset, ACCESIO_BYTE);
+    line->shadow = shadow;
+}
+
+static inline void accesio_pci_bitbang_set(accesio_pci_region* region, accesio_pci_bitbang_line* line, bool level)
+{
+    *(line->shadow) = (level ? (*(line->shadow) | line->mask) : (*(line->shadow) & ~line->mask));
+    accesio_pci_region_write(region, line->offset, ACCESIO_BYTE, *(line->shadow));
+}
+
+/* Shifts the buffers through the lines in process context. Each bit is two
+ * register writes and a read, spaced by the half period; the clock may
+ * stretch between bytes when the task is rescheduled, which SPI tolerates. */
+static inline int accesio_pci_ioctl_internal_bitbang_transfer(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = ACCESIO_SUCCESS;
+    uint32_t i = 0;
+    uint8_t bit = 0;
+    uint8_t mask = 0;
+    uint8_t in = 0;
+    uint8_t out = 0;
+    uint8_t shadows[3];
+    bool cpol = false;
+    bool cpha = false;
+    bool cs_level = false;
+    uint8_t* tx = NULL;
+    uint8_t* rx = NULL;
+    accesio_pci_region* region = NULL;
+    accesio_pci_bitbang_transfer transfer;
+    accesio_pci_bitbang_line clock;
+    accesio_pci_bitbang_line mosi;
+    accesio_pci_bitbang_line cs;
+    accesio_pci_bitbang_line* bound[3];
+    uint8_t bound_count = 0;
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_bitbang_transfer)) == 0) { return -EACCES; }
+    if (copy_from_user(&transfer, (accesio_pci_bitbang_transfer*)arg, sizeof(accesio_pci_bitbang_transfer)) != 0) { return -EIO; }
+    if (transfer.length == 0 || transfer.length > ACCESIO_PCI_BITBANG_MAX) { return -EINVAL; }
+    if (transfer.mode > 3 || transfer.half_period_ns > ACCESIO_PCI_BITBANG_HALF_PERIOD_MAX) { return -EINVAL; }
+    if (transfer.bar == 0) { transfer.bar = accesio_get_bar(ddata->product_id); }
+    if (transfer.bar >= ACCESIO_MAX_REGIONS || ddata->regions[transfer.bar].address_type == ACCESIO_ADDR_INVALID) { return -ENXIO; }
+    region = &(ddata->regions[transfer.bar]);
+    if (!accesio_pci_bitbang_pin_valid(region, &transfer.clock)) { return -EFAULT; }
+    if (transfer.tx != NULL && !accesio_pci_bitbang_pin_valid(region, &transfer.mosi)) { return -EFAULT; }
+    if (transfer.rx != NULL && !accesio_pci_bitbang_pin_valid(region, &transfer.miso)) { return -EFAULT; }
+    if ((transfer.flags & ACCESIO_PCI_BITBANG_CS) && !accesio_pci_bitbang_pin_valid(region, &transfer.cs)) { return -EFAULT; }
+    tx = kzalloc(transfer.length, GFP_KERNEL);
+    rx = kzalloc(transfer.length, GFP_KERNEL);
+    if (tx == NULL || rx == NULL) { ret = -ENOMEM; goto exit; }
+    if (transfer.tx != NULL && copy_from_user(tx, transfer.tx, transfer.length) != 0) { ret = -EIO; goto exit; }
+    ret = mutex_lock_interruptible(&(ddata->bitbang_lock));
+    if (ret < 0) { goto exit; }
+    cpol = ((transfer.mode & 0x02) != 0);
+    cpha = ((transfer.mode & 0x01) != 0);
+    cs_level = ((transfer.flags & ACCESIO_PCI_BITBANG_CS_HIGH) != 0);
+    accesio_pci_bitbang_bind(region, &transfer.clock, &clock, bound, bound_count, &shadows[bound_count]);
+    bound[bound_count++] = &clock;
+    if (transfer.tx != NULL) {
+        accesio_pci_bitbang_bind(region, &transfer.mosi, &mosi, bound, bound_count, &shadows[bound_count]);
+        bound[bound_count++] = &mosi;
+    }
+    if (transfer.flags & ACCESIO_PCI_BITBANG_CS) {
+        accesio_pci_bitbang_bind(region, &transfer.cs, &cs, bound, bound_count, &shadows[bound_count]);
+        bound[bound_count++] = &cs;
+    }
+    accesio_pci_bitbang_set(region, &clock, cpol);
+    if (transfer.flags & ACCESIO_PCI_BITBANG_CS) {
+        accesio_pci_bitbang_set(region, &cs, cs_level);
+        ndelay(transfer.half_period_ns);
+    }
+    for (i = 0; i < transfer.length; ++i) {
+        out = tx[i];
+        in = 0;
+        for (bit = 0; bit < 8; ++bit) {
+            mask = ((transfer.flags & ACCESIO_PCI_BITBANG_LSB_FIRST) ? (1 << bit) : (0x80 >> bit));
+            if (!cpha) {
+                // data is set up before the leading edge and sampled on it
+                if (transfer.tx != NULL) { accesio_pci_bitbang_set(region, &mosi, (out & mask) != 0); }
+                ndelay(transfer.half_period_ns);
+                accesio_pci_bitbang_set(region, &clock, !cpol);
+                if (transfer.rx != NULL && (accesio_pci_region_read(region, transfer.miso.offset, ACCESIO_BYTE) & (1 << transfer.miso.bit))) { in |= mask; }
+                ndelay(transfer.half_period_ns);
+                accesio_pci_bitbang_set(region, &clock, cpol);
+            } else {
+                // data changes on the leading edge and is sampled on the trailing edge
+                accesio_pci_bitbang_set(region, &clock, !cpol);
+                if (transfer.tx != NULL) { accesio_pci_bitbang_set(region, &mosi, (out & mask) != 0); }
+                ndelay(transfer.half_period_ns);
+                accesio_pci_bitbang_set(region, &clock, cpol);
+                if (transfer.rx != NULL && (accesio_pci_region_read(region, transfer.miso.offset, ACCESIO_BYTE) & (1 << transfer.miso.bit))) { in |= mask; }
+                ndelay(transfer.half_period_ns);
+            }
+        }
+        rx[i] = in;
+        cond_resched();
+    }
+    if (transfer.flags & ACCESIO_PCI_BITBANG_CS) {
+        ndelay(transfer.half_period_ns);
+        accesio_pci_bitbang_set(region, &cs, !cs_level);
+    }
+    mutex_unlock(&(ddata->bitbang_lock));
+    if (transfer.rx != NULL && copy_to_user(transfer.rx, rx, transfer.length) != 0) { ret = -EIO; }
+exit:
+    kfree(rx);
+    kfree(tx);
+    return ret;
+}
+
+#define ACCESIO_PCI_QUADRATURE_ERROR 2
+
+/* Position change indexed by (previous state << 2) | state, where the state
+ * is (A << 1) | B. A leading B (00, 10, 11, 01) counts up. */
+static const int8_t accesio_pci_quadrature_step[16] = {
+     0, -1,  1,  2,
+     1,  0,  2, -1,
+    -1,  2,  0,  1,
+     2,  1, -1,  0,
+};
+
+// returns the index of the register in the sampled set, adding it if needed
+static uint8_t accesio_pci_quadrature_register(accesio_pci_quadrature* quadrature, uint16_t offset)
+{
+    uint8_t i = 0;
+    for (i = 0; i < quadrature->registers; ++i) {
+        if (quadrature->offset[i] == offset) { return i; }
+    }
+    quadrature->offset[quadrature->registers] = offset;
+    return quadrature->registers++;
+}
+
+// samples every encoder, called with the lock held
+static void accesio_pci_quadrature_sample(accesio_pci_quadrature* quadrature, bool count)
+{
+    uint8_t i = 0;
+    uint8_t state = 0;
+    int8_t step = 0;
+    uint8_t values[ACCESIO_PCI_QUADRATURE_CHANNELS * 2];
+    for (i = 0; i < quadrature->registers; ++i) {
+        values[i] = accesio_pci_region_read(quadrature->region, quadrature->offset[i], ACCESIO_BYTE);
+    }
+    quadrature->timestamp_ns = ktime_get_ns();
+    for (i = 0; i < quadrature->channels; ++i) {
+        state = ((values[quadrature->a_register[i]] & quadrature->a_mask[i]) ? 0x02 : 0x00) |
+                ((values[quadrature->b_register[i]] & quadrature->b_mask[i]) ? 0x01 : 0x00);
+        if (count) {
+            step = accesio_pci_quadrature_step[(quadrature->state[i] << 2) | state];
+            if (step == ACCESIO_PCI_QUADRATURE_ERROR) {
+                ++quadrature->errors[i];
+            } else {
+                quadrature->position[i] += step;
+            }
+        }
+        quadrature->state[i] = state;
+    }
+}
+
+static enum hrtimer_restart accesio_pci_quadrature_tick(struct hrtimer* timer)
+{
+    accesio_pci_quadrature* quadrature = container_of(timer, accesio_pci_quadrature, timer);
+    unsigned long flags = 0;
+    u64 overrun = 0;
+    spin_lock_irqsave(&(quadrature->lock), flags);
+    if (!quadrature->running) {
+        spin_unlock_irqrestore(&(quadrature->lock), flags);
+        return HRTIMER_NORESTART;
+    }
+    accesio_pci_quadrature_sample(quadrature, true);
+    ++quadrature->samples;
+    overrun = hrtimer_forward_now(timer, quadrature->period);
+    if (overrun > 1) { quadrature->missed += (overrun - 1); }
+    spin_unlock_irqrestore(&(quadrature->lock), flags);
+    return HRTIMER_RESTART;
+}
+
+static void accesio_pci_quadrature_stop(accesio_pci_device_info* ddata)
+{
+    unsigned long flags = 0;
+    spin_lock_irqsave(&(ddata->quadrature.lock), flags);
+    ddata->quadrature.running = false;
+    spin_unlock_irqrestore(&(ddata->quadrature.lock), flags);
+    hrtimer_cancel(&(ddata->quadrature.timer));
+}
+
+static inline int accesio_pci_ioctl_internal_quadrature_start(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    uint8_t i = 0;
+    unsigned long flags = 0;
+    accesio_pci_quadrature_config config;
+    accesio_pci_quadrature* quadrature = &ddata->quadrature;
+    accesio_pci_region* region = NULL;
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_quadrature_config)) == 0) { return -EACCES; }
+    if (copy_from_user(&config, (accesio_pci_quadrature_config*)arg, sizeof(accesio_pci_quadrature_config)) != 0) { return -EIO; }
+    if (config.channels == 0 || config.channels > ACCESIO_PCI_QUADRATURE_CHANNELS) { return -EINVAL; }
+    if (config.period_ns < ACCESIO_PCI_QUADRATURE_PERIOD_MIN) { return -EINVAL; }
+    if (config.bar == 0) { config.bar = accesio_get_bar(ddata->product_id); }
+    if (config.bar >= ACCESIO_MAX_REGIONS || ddata->regions[config.bar].address_type == ACCESIO_ADDR_INVALID) { return -ENXIO; }
+    region = &(ddata->regions[config.bar]);
+    for (i = 0; i < config.channels; ++i) {
+        if (config.channel[i].a_bit >= 8 || config.channel[i].b_bit >= 8) { return -EINVAL; }
+        if (config.channel[i].a_offset >= region->length || config.channel[i].b_offset >= region->length) { return -EFAULT; }
+    }
+    accesio_pci_quadrature_stop(ddata);
+    spin_lock_irqsave(&(quadrature->lock), flags);
+    quadrature->region = region;
+    quadrature->period = ns_to_ktime(config.period_ns);
+    quadrature->channels = config.channels;
+    quadrature->registers = 0;
+    for (i = 0; i < config.channels; ++i) {
+        quadrature->a_register[i] = accesio_pci_quadrature_register(quadrature, config.channel[i].a_offset);
+        quadrature->a_mask[i] = (1 << config.channel[i].a_bit);
+        quadrature->b_register[i] = accesio_pci_quadrature_register(quadrature, config.channel[i].b_offset);
+        quadrature->b_mask[i] = (1 << config.channel[i].b_bit);
+        quadrature->position[i] = 0;
+        quadrature->errors[i] = 0;
+    }
+    quadrature->samples = 0;
+    quadrature->missed = 0;
+    accesio_pci_quadrature_sample(quadrature, false);
+    quadrature->running = true;
+    spin_unlock_irqrestore(&(quadrature->lock), flags);
+    hrtimer_start(&(quadrature->timer), quadrature->period, HRTIMER_MODE_REL);
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_pci_ioctl_internal_quadrature_counts(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    unsigned long flags = 0;
+    accesio_pci_quadrature_counts counts;
+    accesio_pci_quadrature* quadrature = &ddata->quadrature;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_pci_quadrature_counts)) == 0) { return -EACCES; }
+    memset(&counts, 0, sizeof(accesio_pci_quadrature_counts));
+    spin_lock_irqsave(&(quadrature->lock), flags);
+    if (quadrature->running) {
+        memcpy(counts.position, quadrature->position, sizeof(counts.position));
+        memcpy(counts.errors, quadrature->errors, sizeof(counts.errors));
+        counts.samples = quadrature->samples;
+        counts.missed = quadrature->missed;
+        counts.timestamp_ns = quadrature->timestamp_ns;
+        counts.channels = quadrature->channels;
+    }
+    spin_unlock_irqrestore(&(quadrature->lock), flags);
+    if (copy_to_user((accesio_pci_quadrature_counts*)arg, &counts, sizeof(accesio_pci_quadrature_counts)) != 0) { return -EIO; }
+    return ACCESIO_SUCCESS;
+}
+
+static inline uint32_t accesio_pci_size_mask(uint8_t size)
+{
+    switch (size) {
+        case ACCESIO_BYTE: return 0xFF;
+        case ACCESIO_WORD: return 0xFFFF;
+        default: break;
+    }
+    return 0xFFFFFFFF;
+}
+
+/* Executes every entry that is due, oldest deadline first, then re-arms for
+ * the next one. The completion time is taken right after each write. */
+static enum hrtimer_restart accesio_pci_timed_tick(struct hrtimer* timer)
+{
+    accesio_pci_timed_queue* timed = container_of(timer, accesio_pci_timed_queue, timer);
+    accesio_pci_timed_completion completion;
+    accesio_pci_timed_entry* entry = NULL;
+    enum hrtimer_restart restart = HRTIMER_NORESTART;
+    unsigned long flags = 0;
+    uint32_t done = 0;
+    uint32_t value = 0;
+    bool wake = false;
+    spin_lock_irqsave(&(timed->queue_lock), flags);
+    while (done < timed->count && timed->entries[done].write.deadline_ns <= ktime_get_ns()) {
+        entry = &(timed->entries[done]);
+        value = entry->write.value;
+        if (entry->write.mask != accesio_pci_size_mask(entry->write.size)) {
+            value = (accesio_pci_region_read(entry->region, entry->write.offset, entry->write.size) & ~entry->write.mask) | (value & entry->write.mask);
+        }
+        accesio_pci_region_write(entry->region, entry->write.offset, entry->write.size, value);
+        memset(&completion, 0, sizeof(accesio_pci_timed_completion));
+        completion.executed_ns = ktime_get_ns();
+        completion.deadline_ns = entry->write.deadline_ns;
+        completion.tag = entry->write.tag;
+        if (kfifo_in(&(timed->completions), &completion, 1) == 0) { ++timed->dropped; }
+        wake = true;
+        ++done;
+    }
+    if (done != 0) {
+        timed->count -= done;
+        memmove(timed->entries, &(timed->entries[done]), (timed->count * sizeof(accesio_pci_timed_entry)));
+    }
+    if (timed->count != 0) {
+        hrtimer_set_expires(timer, ns_to_ktime(timed->entries[0].write.deadline_ns));
+        restart = HRTIMER_RESTART;
+    }
+    spin_unlock_irqrestore(&(timed->queue_lock), flags);
+    if (wake) { wake_up_interruptible(&(timed->wait)); }
+    return restart;
+}
+
+static void accesio_pci_timed_stop(accesio_pci_device_info* ddata)
+{
+    unsigned long flags = 0;
+    spin_lock_irqsave(&(ddata->timed.queue_lock), flags);
+    ddata->timed.count = 0;
+    spin_unlock_irqrestore(&(ddata->timed.queue_lock), flags);
+    hrtimer_cancel(&(ddata->timed.timer));
+    mutex_lock(&(ddata->timed.lock));
+    kfree(ddata->timed.entries);
+    ddata->timed.entries = NULL;
+    kfifo_free(&(ddata->timed.completions));
+    mutex_unlock(&(ddata->timed.lock));
+}
+
+/* Inserts the writes into the sorted queue, all or none, and pulls the timer
+ * in when the earliest deadline moved. */
+static inline int accesio_pci_ioctl_internal_timed_write_queue(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = ACCESIO_SUCCESS;
+    uint32_t i = 0;
+    uint32_t position = 0;
+    unsigned long flags = 0;
+    bool rearm = false;
+    ktime_t earliest;
+    accesio_pci_timed_writes request;
+    accesio_pci_timed_write* writes = NULL;
+    accesio_pci_timed_queue* timed = &ddata->timed;
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_pci_timed_writes)) == 0) { return -EACCES; }
+    if (copy_from_user(&request, (accesio_pci_timed_writes*)arg, sizeof(accesio_pci_timed_writes)) != 0) { return -EIO; }
+    if (request.count == 0 || request.count > ACCESIO_PCI_TIMED_WRITE_MAX || request.entries == NULL) { return -EINVAL; }
+    writes = kmalloc_array(request.count, sizeof(accesio_pci_timed_write), GFP_KERNEL);
+    if (writes == NULL) { return -ENOMEM; }
+    if (copy_from_user(writes, request.entries, (request.count * sizeof(accesio_pci_timed_write))) != 0) { ret = -EIO; goto exit; }
+    for (i = 0; i < request.count; ++i) {
+        if (writes[i].bar == 0) { writes[i].bar = accesio_get_bar(ddata->product_id); }
+        if (writes[i].bar >= ACCESIO_MAX_REGIONS || ddata->regions[writes[i].bar].address_type == ACCESIO_ADDR_INVALID) { ret = -ENXIO; goto exit; }
+        if (writes[i].size != ACCESIO_BYTE && writes[i].size != ACCESIO_WORD && writes[i].size != ACCESIO_DWORD) { ret = -EINVAL; goto exit; }
+        if ((writes[i].offset + writes[i].size) > ddata->regions[writes[i].bar].length) { ret = -EFAULT; goto exit; }
+        writes[i].mask &= accesio_pci_size_mask(writes[i].size);
+        if (writes[i].mask == 0) { ret = -EINVAL; goto exit; }
+    }
+    ret = mutex_lock_interruptible(&(timed->lock));
+    if (ret < 0) { goto exit; }
+    if (timed->entries == NULL) {
+        timed->entries = kmalloc_array(ACCESIO_PCI_TIMED_WRITE_MAX, sizeof(accesio_pci_timed_entry), GFP_KERNEL);
+        if (timed->entries == NULL) { ret = -ENOMEM; goto unlock; }
+        ret = kfifo_alloc(&(timed->completions), ACCESIO_PCI_TIMED_WRITE_COMPLETIONS, GFP_KERNEL);
+        if (ret != 0) {
+            kfree(timed->entries);
+            timed->entries = NULL;
+            goto unlock;
+        }
+        timed->dropped = 0;
+    }
+    spin_lock_irqsave(&(timed->queue_lock), flags);
+    if ((timed->count + request.count) > ACCESIO_PCI_TIMED_WRITE_MAX) {
+        spin_unlock_irqrestore(&(timed->queue_lock), flags);
+        ret = -ENOSPC;
+        goto unlock;
+    }
+    for (i = 0; i < request.count; ++i) {
+        // entries with equal deadlines keep the order they were queued in
+        position = timed->count;
+        while (position > 0 && timed->entries[position - 1].write.deadline_ns > writes[i].deadline_ns) { --position; }
+        memmove(&(timed->entries[position + 1]), &(timed->entries[position]), ((timed->count - position) * sizeof(accesio_pci_timed_entry)));
+        timed->entries[position].write = writes[i];
+        timed->entries[position].region = &(ddata->regions[writes[i].bar]);
+        ++timed->count;
+        if (position == 0) { rearm = true; }
+    }
+    earliest = ns_to_ktime(timed->entries[0].write.deadline_ns);
+    spin_unlock_irqrestore(&(timed->queue_lock), flags);
+    if (rearm) { hrtimer_start(&(timed->timer), earliest, HRTIMER_MODE_ABS); }
+unlock:
+    mutex_unlock(&(timed->lock));
+exit:
+    kfree(writes);
+    return ret;
+}
+
+static inline int accesio_pci_ioctl_internal_timed_write_cancel(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    uint32_t i = 0;
+    uint32_t kept = 0;
+    uint32_t tag = 0;
+    unsigned long flags = 0;
+    accesio_pci_timed_queue* timed = &ddata->timed;
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(uint32_t)) == 0) { return -EACCES; }
+    if (copy_from_user(&tag, (uint32_t*)arg, sizeof(uint32_t)) != 0) { return -EIO; }
+    ret = mutex_lock_interruptible(&(timed->lock));
+    if (ret < 0) { return ret; }
+    spin_lock_irqsave(&(timed->queue_lock), flags);
+    for (i = 0; i < timed->count; ++i) {
+        if (tag == ACCESIO_PCI_TIMED_WRITE_ALL || timed->entries[i].write.tag == tag) { continue; }
+        timed->entries[kept++] = timed->entries[i];
+    }
+    ret = (timed->count - kept);
+    timed->count = kept;
+    spin_unlock_irqrestore(&(timed->queue_lock), flags);
+    mutex_unlock(&(timed->lock));
+    // a timer armed for a cancelled entry finds nothing due and re-arms
+    return ret;
+}
+
+static inline int accesio_pci_ioctl_internal_timed_write_pending(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    uint32_t i = 0;
+    uint32_t count = 0;
+    unsigned long flags = 0;
+    accesio_pci_timed_writes request;
+    accesio_pci_timed_write* writes = NULL;
+    accesio_pci_timed_queue* timed = &ddata->timed;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_pci_timed_writes)) == 0) { return -EACCES; }
+    if (copy_from_user(&request, (accesio_pci_timed_writes*)arg, sizeof(accesio_pci_timed_writes)) != 0) { return -EIO; }
+    if (request.count != 0 && request.entries == NULL) { return -EINVAL; }
+    request.count = min_t(uint32_t, request.count, ACCESIO_PCI_TIMED_WRITE_MAX);
+    if (request.count != 0) {
+        writes = kmalloc_array(request.count, sizeof(accesio_pci_timed_write), GFP_KERNEL);
+        if (writes == NULL) { return -ENOMEM; }
+    }
+    ret = mutex_lock_interruptible(&(timed->lock));
+    if (ret < 0) { goto exit; }
+    spin_lock_irqsave(&(timed->queue_lock), flags);
+    count = min(request.count, timed->count);
+    for (i = 0; i < count; ++i) {
+        writes[i] = timed->entries[i].write;
+    }
+    ret = timed->count;
+    spin_unlock_irqrestore(&(timed->queue_lock), flags);
+    mutex_unlock(&(timed->lock));
+    request.count = count;
+    if (count != 0 && copy_to_user(request.entries, writes, (count * sizeof(accesio_pci_timed_write))) != 0) { ret = -EIO; goto exit; }
+    if (copy_to_user((accesio_pci_timed_writes*)arg, &request, sizeof(accesio_pci_timed_writes)) != 0) { ret = -EIO; }
+exit:
+    kfree(writes);
+    return ret;
+}
+
+static inline int accesio_pci_ioctl_internal_timed_write_completions(accesio_pci_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    unsigned int count = 0;
+    unsigned long flags = 0;
+    accesio_pci_timed_completions request;
+    accesio_pci_timed_completion* completions = NULL;
+    accesio_pci_timed_queue* timed = &ddata->timed;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_pci_timed_completions)) == 0) { return -EACCES; }
+    if (copy_from_user(&request, (accesio_pci_timed_completions*)arg, sizeof(accesio_pci_timed_completions)) != 0) { return -EIO; }
+    if (request.count == 0 || request.completions == NULL) { return -EINVAL; }
+    count = min_t(uint32_t, request.count, ACCESIO_PCI_TIMED_WRITE_COMPLETIONS);
+    completions = kmalloc_array(count, sizeof(accesio_pci_timed_completion), GFP_KERNEL);
+    if (completions == NULL) { return -ENOMEM; }
+    ret = mutex_lock_interruptible(&(timed->lock));
+    if (ret < 0) { goto exit; }
+    spin_lock_irqsave(&(timed->queue_lock), flags);
+    count = (timed->entries != NULL ? kfifo_out(&(timed->completions), completions, count) : 0);
+    request.dropped = timed->dropped;
+    spin_unlock_irqrestore(&(timed->queue_lock), flags);
+    mutex_unlock(&(timed->lock));
+    if (count != 0 && copy_to_user(request.completions, completions, (count * sizeof(accesio_pci_timed_completion))) != 0) { ret = -EIO; goto exit; }
+    if (copy_to_user((accesio_pci_timed_completions*)arg, &request, sizeof(accesio_pci_timed_completions)) != 0) { ret = -EIO; goto exit; }
+    ret = count;
+exit:
+    kfree(completions);
+    return ret;
+}
+
+// stops anything the driver is running on behalf of the device handle
+static void accesio_pci_device_stop(accesio_pci_device_info* ddata)
+{
+    accesio_pci_ai_stream_stop(ddata);
+    mutex_lock(&(ddata->ai_stream.lock));
+    kfifo_free(&(ddata->ai_stream.ring));
+    mutex_unlock(&(ddata->ai_stream.lock));
+    accesio_pci_da_playback_stop(ddata);
+    mutex_lock(&(ddata->da_playback.lock));
+    accesio_pci_da_playback_free(&(ddata->da_playback));
+    mutex_unlock(&(ddata->da_playback.lock));
+    accesio_pci_dio_pattern_stop(ddata);
+    mutex_lock(&(ddata->dio_pattern.lock));
+    accesio_pci_dio_pattern_free(&(ddata->dio_pattern));
+    mutex_unlock(&(ddata->dio_pattern.lock));
+    mutex_lock(&accesio_pci_devices_lock);
+    ddata->group.count = 0;
+    mutex_unlock(&accesio_pci_devices_lock);
+    accesio_pci_wdg_service_stop(ddata);
+    accesio_pci_debounce_stop(ddata);
+    mutex_lock(&(ddata->debounce.lock));
+    kfifo_free(&(ddata->debounce.events));
+    mutex_unlock(&(ddata->debounce.lock));
+    accesio_pci_counter_stop(ddata);
+    mutex_lock(&(ddata->counter.lock));
+    kfifo_free(&(ddata->counter.samples));
+    mutex_unlock(&(ddata->counter.lock));
+    accesio_pci_quadrature_stop(ddata);
+    accesio_pci_timed_stop(ddata);
+}
+
 static int accesio_pci_ioctl_internal(struct file* filp, unsigned int cmd, unsigned long arg)
 {
     unsigned long flags = 0;
@@ -544,6 +2279,126 @@ static int accesio_pci_ioctl_internal(struct file* filp, unsigned int cmd, unsig
 
         case ACCESIO_IOCTL_GET_DEVICE_PLX_END:
             return ddata->plx_region.end;
+
+        case ACCESIO_IOCTL_PCI_AI_STREAM_START:
+            return accesio_pci_ioctl_internal_ai_stream_start(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_AI_STREAM_STOP:
+            if (!accesio_pci_is_ai12(ddata->product_id)) { return -ENOSYS; }
+            accesio_pci_ai_stream_stop(ddata);
+            return ACCESIO_SUCCESS;
+
+        case ACCESIO_IOCTL_PCI_AI_STREAM_STATUS:
+            return accesio_pci_ioctl_internal_ai_stream_status(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_DA_PLAYBACK_SETUP:
+            return accesio_pci_ioctl_internal_da_playback_setup(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_DA_PLAYBACK_LOAD:
+            return accesio_pci_ioctl_internal_da_playback_load(ddata, filp, arg);
+
+        case ACCESIO_IOCTL_PCI_DA_PLAYBACK_START:
+            return accesio_pci_ioctl_internal_da_playback_start(ddata);
+
+        case ACCESIO_IOCTL_PCI_DA_PLAYBACK_STOP:
+            if (!accesio_pci_is_da12(ddata->product_id)) { return -ENOSYS; }
+            accesio_pci_da_playback_stop(ddata);
+            return ACCESIO_SUCCESS;
+
+        case ACCESIO_IOCTL_PCI_DA_PLAYBACK_STATUS:
+            return accesio_pci_ioctl_internal_da_playback_status(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_DIO_PATTERN_SETUP:
+            return accesio_pci_ioctl_internal_dio_pattern_setup(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_DIO_PATTERN_LOAD:
+            return accesio_pci_ioctl_internal_dio_pattern_load(ddata, filp, arg);
+
+        case ACCESIO_IOCTL_PCI_DIO_PATTERN_START:
+            return accesio_pci_ioctl_internal_dio_pattern_start(ddata);
+
+        case ACCESIO_IOCTL_PCI_DIO_PATTERN_STOP:
+            accesio_pci_dio_pattern_stop(ddata);
+            return ACCESIO_SUCCESS;
+
+        case ACCESIO_IOCTL_PCI_DIO_PATTERN_STATUS:
+            return accesio_pci_ioctl_internal_dio_pattern_status(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_GROUP_BIND:
+            return accesio_pci_ioctl_internal_group_bind(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_GROUP_READ:
+            return accesio_pci_ioctl_internal_group_transfer(ddata, arg, false);
+
+        case ACCESIO_IOCTL_PCI_GROUP_WRITE:
+            return accesio_pci_ioctl_internal_group_transfer(ddata, arg, true);
+
+        case ACCESIO_IOCTL_PCI_WDG_SERVICE_START:
+            return accesio_pci_ioctl_internal_wdg_service_start(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_WDG_SERVICE_STOP:
+            if (!accesio_pci_is_wdg(ddata->product_id)) { return -ENOSYS; }
+            accesio_pci_wdg_service_stop(ddata);
+            return ACCESIO_SUCCESS;
+
+        case ACCESIO_IOCTL_PCI_WDG_HEARTBEAT:
+            return accesio_pci_ioctl_internal_wdg_heartbeat(ddata);
+
+        case ACCESIO_IOCTL_PCI_WDG_SERVICE_STATUS:
+            return accesio_pci_ioctl_internal_wdg_service_status(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_DEBOUNCE_START:
+            return accesio_pci_ioctl_internal_debounce_start(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_DEBOUNCE_STOP:
+            if (!accesio_pci_is_iiro(ddata->product_id)) { return -ENOSYS; }
+            accesio_pci_debounce_stop(ddata);
+            return ACCESIO_SUCCESS;
+
+        case ACCESIO_IOCTL_PCI_DEBOUNCE_EVENTS:
+            return accesio_pci_ioctl_internal_debounce_events(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_DEBOUNCE_STATUS:
+            return accesio_pci_ioctl_internal_debounce_status(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_COUNTER_CAPTURE:
+            return accesio_pci_ioctl_internal_counter_capture(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_COUNTER_PERIODIC_START:
+            return accesio_pci_ioctl_internal_counter_periodic_start(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_COUNTER_PERIODIC_STOP:
+            if (!accesio_pci_has_8254(ddata->product_id)) { return -ENOSYS; }
+            accesio_pci_counter_stop(ddata);
+            return ACCESIO_SUCCESS;
+
+        case ACCESIO_IOCTL_PCI_COUNTER_READ:
+            return accesio_pci_ioctl_internal_counter_read(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_BITBANG_TRANSFER:
+            return accesio_pci_ioctl_internal_bitbang_transfer(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_QUADRATURE_START:
+            return accesio_pci_ioctl_internal_quadrature_start(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_QUADRATURE_STOP:
+            accesio_pci_quadrature_stop(ddata);
+            return ACCESIO_SUCCESS;
+
+        case ACCESIO_IOCTL_PCI_QUADRATURE_COUNTS:
+            return accesio_pci_ioctl_internal_quadrature_counts(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_TIMED_WRITE_QUEUE:
+            return accesio_pci_ioctl_internal_timed_write_queue(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_TIMED_WRITE_CANCEL:
+            return accesio_pci_ioctl_internal_timed_write_cancel(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_TIMED_WRITE_PENDING:
+            return accesio_pci_ioctl_internal_timed_write_pending(ddata, arg);
+
+        case ACCESIO_IOCTL_PCI_TIMED_WRITE_COMPLETIONS:
+            return accesio_pci_ioctl_internal_timed_write_completions(ddata, arg);
     };
     return -ENOSYS;
 }
@@ -587,6 +2442,11 @@ static int accesio_pci_probe(struct pci_dev* pdev, const struct pci_device_id* i
         cdev_del(&ddata->cdev);
         goto irq_error;
     }
+    mutex_lock(&accesio_pci_devices_lock);
+    if (ddata->device_index < ACCESIO_PCI_MAX_CARDS) {
+        accesio_pci_devices[ddata->device_index] = ddata;
+    }
+    mutex_unlock(&accesio_pci_devices_lock);
     return ACCESIO_SUCCESS;
 
     irq_error:
@@ -598,6 +2458,12 @@ static int accesio_pci_probe(struct pci_dev* pdev, const struct pci_device_id* i
 static void accesio_pci_remove(struct pci_dev* pdev)
 {
     accesio_pci_device_info* ddata = pci_get_drvdata(pdev);
+    mutex_lock(&accesio_pci_devices_lock);
+    if (ddata->device_index < ACCESIO_PCI_MAX_CARDS && accesio_pci_devices[ddata->device_index] == ddata) {
+        accesio_pci_devices[ddata->device_index] = NULL;
+    }
+    mutex_unlock(&accesio_pci_devices_lock);
+    accesio_pci_device_stop(ddata);
     spin_lock(&(ddata->irq_lock));
     if (ddata->irq_capable) { free_irq(pdev->irq, ddata); }
     spin_unlock(&(ddata->irq_lock));
@@ -660,6 +2526,7 @@ static int accesio_pci_close(struct inode* inode, struct file* filp)
         #if LINUX_VERSION_CODE < KERNEL_VERSION(2,6,39)
             MOD_DEC_USE_COUNT;
         #endif
+        accesio_pci_device_stop(ddata);
         atomic_dec(&(ddata->open_count));
     }
     return ACCESIO_SUCCESS;
@@ -672,6 +2539,10 @@ static ssize_t accesio_pci_read(struct file* filp, char *__user buf, size_t len,
     uint8_t data = 0;
     size_t wrote = 0;
     if (len == 0) { return 0; }
+    // while streaming (or until drained) the handle reads samples, not registers
+    if (ddata->ai_stream.running || !kfifo_is_empty(&(ddata->ai_stream.ring))) {
+        return accesio_pci_ai_stream_read(ddata, filp, buf, len);
+    }
     if (ddata->regions[bar].address_type == ACCESIO_ADDR_INVALID) { return 0; }
     if (filp->f_pos > ddata->regions[bar].length) { return 0; }
     if (buf == NULL) { return 0; }
@@ -710,6 +2581,33 @@ static ssize_t accesio_pci_write(struct file* filp, const char *__user buf, size
     return wrote;
 }
 
+static unsigned int accesio_pci_poll(struct file* filp, poll_table* wait)
+{
+    unsigned int mask = 0;
+    accesio_pci_device_info* ddata = (accesio_pci_device_info*)filp->private_data;
+    poll_wait(filp, &(ddata->ai_stream.wait), wait);
+    poll_wait(filp, &(ddata->da_playback.wait), wait);
+    poll_wait(filp, &(ddata->dio_pattern.wait), wait);
+    poll_wait(filp, &(ddata->debounce.wait), wait);
+    poll_wait(filp, &(ddata->counter.wait), wait);
+    poll_wait(filp, &(ddata->timed.wait), wait);
+    if (!kfifo_is_empty(&(ddata->debounce.events)) || !kfifo_is_empty(&(ddata->counter.samples)) ||
+        !kfifo_is_empty(&(ddata->timed.completions))) {
+        mask |= POLLPRI;
+    }
+    if (!kfifo_is_empty(&(ddata->ai_stream.ring))) {
+        mask |= (POLLIN | POLLRDNORM);
+    }
+    // writable when playback can take another buffer
+    if (ddata->da_playback.running && (ddata->da_playback.bank_frames[0] == 0 || ddata->da_playback.bank_frames[1] == 0)) {
+        mask |= (POLLOUT | POLLWRNORM);
+    }
+    if (ddata->dio_pattern.running && ddata->dio_pattern.streaming && ddata->dio_pattern.count < ddata->dio_pattern.capacity) {
+        mask |= (POLLOUT | POLLWRNORM);
+    }
+    return mask;
+}
+
 static loff_t accesio_pci_seek(struct file* filp, loff_t offset, int origin)
 {
     accesio_pci_device_info* ddata = (accesio_pci_device_info*)filp->private_data;
@@ -30,4 +30,13 @@
 #define ACCESIO_PCIE_INB 0x4C
 #define ACCESIO_PCIE_IRQ 0x04
 
+// PCI-AI12-16 family register offsets (BAR 2)
+#define ACCESIO_PCI_AI12_FIFO 0x00
+#define ACCESIO_PCI_AI12_IRQ_CTRL 0x04
+#define ACCESIO_PCI_AI12_IRQ_FIFO_OFF 0x01 // leaves the counter enabled
+
+// 8254 counter/timer, relative to the chip base
+#define ACCESIO_PCI_8254_CONTROL 0x03
+#define ACCESIO_PCI_8254_READBACK_COUNT 0xD0 // read-back command, latch count only
+
 #endif // ACCESIO_LINUX_DECLARATIONS_H
\ No newline at end of file
@@ -38,6 +38,15 @@ static int accesio_pci_close(struct inode* inode, struct file* filp);
 static ssize_t accesio_pci_read(struct file* filp, char *__user buf, size_t len, loff_t* off);
 static ssize_t accesio_pci_write(struct file* filp, const char *__user buf, size_t len, loff_t *off);
 static loff_t accesio_pci_seek(struct file* filp, loff_t off, int origin);
+static unsigned int accesio_pci_poll(struct file* filp, poll_table* wait);
+static enum hrtimer_restart accesio_pci_da_playback_tick(struct hrtimer* timer);
+static enum hrtimer_restart accesio_pci_dio_pattern_tick(struct hrtimer* timer);
+static enum hrtimer_restart accesio_pci_wdg_service_tick(struct hrtimer* timer);
+static enum hrtimer_restart accesio_pci_debounce_tick(struct hrtimer* timer);
+static bool accesio_pci_debounce_cos(accesio_pci_device_info* ddata);
+static enum hrtimer_restart accesio_pci_counter_tick(struct hrtimer* timer);
+static enum hrtimer_restart accesio_pci_quadrature_tick(struct hrtimer* timer);
+static enum hrtimer_restart accesio_pci_timed_tick(struct hrtimer* timer);
 #if LINUX_VERSION_CODE < KERNEL_VERSION(2,6,39)
 static int accesio_pci_ioctl(struct inode* inode, struct file* filp, unsigned int cmd, unsigned long arg);
 #else 
@@ -65,6 +74,7 @@ static struct file_operations accesio_pci_file_ops = {
     .read           = accesio_pci_read,
     .write          = accesio_pci_write,
     .llseek         = accesio_pci_seek,
+    .poll           = accesio_pci_poll,
 #if LINUX_VERSION_CODE < KERNEL_VERSION(2,6,39)
     .ioctl          = accesio_pci_ioctl,
 #else
@@ -74,4 +84,8 @@ static struct file_operations accesio_pci_file_ops = {
 
 static struct cdev accesio_pci_cdev;
 
+// devices by index, for operations that span several cards
+static accesio_pci_device_info* accesio_pci_devices[ACCESIO_PCI_MAX_CARDS];
+static DEFINE_MUTEX(accesio_pci_devices_lock);
+
 #endif // ACCESIO_LINUX_DRIVER_H
\ No newline at end of file
@@ -38,6 +38,172 @@ typedef struct accesio_pci_region {
     enum accesio_device_address address_type;
 } accesio_pci_region;
 
+typedef struct accesio_pci_ai_stream {
+    DECLARE_KFIFO_PTR(ring, uint16_t); // samples drained from the card FIFO
+    wait_queue_head_t wait;            // readers waiting on samples
+    struct mutex lock;                 // serializes start/stop/read
+    bool running;                      // set/cleared under irq_lock
+    uint32_t samples_per_irq;
+    uint8_t irq_enable;
+    uint64_t interrupts;
+    uint64_t samples;
+    uint64_t overruns;
+} accesio_pci_ai_stream;
+
+typedef struct accesio_pci_da_playback {
+    struct hrtimer timer;       // writes one frame per period
+    wait_queue_head_t wait;     // loaders waiting on a free buffer
+    struct mutex lock;          // serializes setup/load/start/stop
+    spinlock_t bank_lock;       // guards the bank state against the timer
+    uint16_t* banks[2];
+    uint32_t bank_frames[2];    // frames loaded in each bank, 0 when free
+    uint32_t current;           // bank being played
+    uint32_t position;          // next frame of the current bank
+    uint32_t channels;
+    uint32_t frames;            // capacity of each bank in frames
+    ktime_t period;
+    accesio_pci_region* region;
+    uint16_t offset;
+    uint16_t stride;
+    bool loop;
+    bool running;
+    uint64_t played;
+    uint64_t buffers;
+    uint64_t underruns;
+    uint64_t missed;
+} accesio_pci_da_playback;
+
+typedef struct accesio_pci_dio_pattern {
+    struct hrtimer timer;       // applies the steps at their absolute due time
+    wait_queue_head_t wait;     // appenders waiting on ring space
+    struct mutex lock;          // serializes setup/load/start/stop
+    spinlock_t step_lock;       // guards the steps and counters against the timer
+    accesio_pci_dio_pattern_step* steps;
+    uint32_t capacity;
+    uint32_t count;             // steps in the table, or queued in the ring
+    uint32_t head;              // ring slot the next appended step goes to
+    uint32_t position;          // next table step, or the ring tail
+    uint32_t loops;
+    uint32_t late_ns;
+    accesio_pci_region* region;
+    bool streaming;
+    bool running;
+    bool starved;               // streaming ran dry, the timer is idle until an append
+    uint64_t executed;
+    uint64_t loops_done;
+    uint64_t underruns;
+    uint64_t late;
+    uint64_t max_late_ns;
+} accesio_pci_dio_pattern;
+
+typedef struct accesio_pci_wdg_service {
+    struct hrtimer timer;       // refreshes the watchdog every period
+    spinlock_t lock;            // guards the state against the timer
+    accesio_pci_region* region;
+    ktime_t period;
+    ktime_t last_heartbeat;
+    uint64_t liveness_ns;
+    uint32_t value;
+    uint16_t offset;
+    uint8_t size;
+    bool read;
+    bool running;
+    bool withheld;
+    uint64_t kicks;
+    uint64_t heartbeats;
+    uint64_t lapses;
+    uint64_t min_heartbeat_margin_ns;
+    uint64_t max_kick_late_ns;
+} accesio_pci_wdg_service;
+
+typedef struct accesio_pci_debounce_port {
+    ktime_t changed_at[8];      // last raw change of each bit
+    uint64_t stable_ns;
+    uint16_t offset;
+    uint8_t raw;                // last sampled value
+    uint8_t value;              // debounced value
+} accesio_pci_debounce_port;
+
+typedef struct accesio_pci_debounce {
+    struct hrtimer timer;       // samples the inputs until they settle
+    wait_queue_head_t wait;     // pollers waiting on events
+    struct mutex lock;          // serializes start/stop/events
+    spinlock_t state_lock;      // guards the ports and queue against the timer and irq
+    DECLARE_KFIFO_PTR(events, accesio_pci_debounce_event);
+    accesio_pci_debounce_port port[ACCESIO_PCI_DEBOUNCE_PORTS];
+    accesio_pci_region* region;
+    ktime_t period;
+    uint8_t ports;
+    bool running;
+    bool idle;                  // settled, the timer waits on a COS interrupt
+    uint64_t samples;
+    uint64_t bounces;
+    uint64_t transitions;
+    uint64_t interrupts;
+    uint64_t dropped;
+} accesio_pci_debounce;
+
+typedef struct accesio_pci_counter {
+    struct hrtimer timer;       // periodic captures
+    wait_queue_head_t wait;     // pollers waiting on captures
+    struct mutex lock;          // serializes periodic start/stop/read
+    spinlock_t latch_lock;      // one capture at a time, the 8254 byte order is stateful
+    DECLARE_KFIFO_PTR(samples, accesio_pci_counter_sample);
+    accesio_pci_counter_config config;
+    accesio_pci_region* region;
+    ktime_t period;
+    bool running;
+    uint64_t dropped;
+} accesio_pci_counter;
+
+typedef struct accesio_pci_bitbang_line {
+    uint8_t* shadow;            // register image, shared by the lines of one register
+    uint16_t offset;
+    uint8_t mask;
+} accesio_pci_bitbang_line;
+
+typedef struct accesio_pci_quadrature {
+    struct hrtimer timer;       // samples the encoder inputs
+    spinlock_t lock;            // guards the counters against the timer
+    accesio_pci_region* region;
+    ktime_t period;
+    bool running;
+    uint8_t channels;
+    uint8_t registers;          // distinct registers read each sample
+    uint16_t offset[ACCESIO_PCI_QUADRATURE_CHANNELS * 2];
+    uint8_t a_register[ACCESIO_PCI_QUADRATURE_CHANNELS];
+    uint8_t a_mask[ACCESIO_PCI_QUADRATURE_CHANNELS];
+    uint8_t b_register[ACCESIO_PCI_QUADRATURE_CHANNELS];
+    uint8_t b_mask[ACCESIO_PCI_QUADRATURE_CHANNELS];
+    uint8_t state[ACCESIO_PCI_QUADRATURE_CHANNELS];
+    int64_t position[ACCESIO_PCI_QUADRATURE_CHANNELS];
+    uint64_t errors[ACCESIO_PCI_QUADRATURE_CHANNELS];
+    uint64_t samples;
+    uint64_t missed;
+    uint64_t timestamp_ns;
+} accesio_pci_quadrature;
+
+typedef struct accesio_pci_timed_entry {
+    accesio_pci_timed_write write;
+    accesio_pci_region* region;
+} accesio_pci_timed_entry;
+
+typedef struct accesio_pci_timed_queue {
+    struct hrtimer timer;       // fires at the earliest deadline
+    wait_queue_head_t wait;     // pollers waiting on completions
+    struct mutex lock;          // serializes the ioctls and the allocation
+    spinlock_t queue_lock;      // guards the entries and completions against the timer
+    DECLARE_KFIFO_PTR(completions, accesio_pci_timed_completion);
+    accesio_pci_timed_entry* entries; // sorted by deadline
+    uint32_t count;
+    uint64_t dropped;
+} accesio_pci_timed_queue;
+
+typedef struct accesio_pci_group {
+    uint32_t count;             // guarded by accesio_pci_devices_lock
+    uint32_t device_index[ACCESIO_PCI_GROUP_MAX];
+} accesio_pci_group;
+
 typedef struct accesio_pci_device_info {
     uint32_t device_index;
     uint32_t product_id;
@@ -56,6 +222,16 @@ typedef struct accesio_pci_device_info {
     struct device* dev;
     unsigned int num_channels;
     const struct pci_device_id* pci_id;
+    accesio_pci_ai_stream ai_stream;
+    accesio_pci_da_playback da_playback;
+    accesio_pci_dio_pattern dio_pattern;
+    accesio_pci_group group;
+    accesio_pci_wdg_service wdg_service;
+    accesio_pci_debounce debounce;
+    accesio_pci_counter counter;
+    struct mutex bitbang_lock;  // one bit-banged transfer at a time
+    accesio_pci_quadrature quadrature;
+    accesio_pci_timed_queue timed;
 } accesio_pci_device_info;
 
 #endif // ACCESIO_DRIVER_BUILD
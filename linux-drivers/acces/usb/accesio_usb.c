@@ -34,22 +34,6 @@
 #include "module/types.h"
 #include "module/driver.h"
 
-#if defined(CONFIG_VMAP_STACK)
-    #define ACCESIO_VMAP_DATA_DECL void* vmapped_data = NULL;
-    #define ACCESIO_VMAP_ALLOC(len) vmapped_data = kzalloc(len, GFP_KERNEL);
-    #define ACCESIO_VMAP_DATA_COPY(data, len) memcpy(vmapped_data, data, len);
-    #define ACCESIO_VMAP_COPY_DATA(data, len) memcpy(data, vmapped_data, len);
-    #define ACCESIO_VMAP_DATA_REF(data) vmapped_data
-    #define ACCESIO_VMAP_FREE kfree(vmapped_data);
-#else
-    #define ACCESIO_VMAP_DATA_DECL 
-    #define ACCESIO_VMAP_ALLOC(len)
-    #define ACCESIO_VMAP_DATA_COPY(data, len) 
-    #define ACCESIO_VMAP_COPY_DATA(data, len)
-    #define ACCESIO_VMAP_DATA_REF(data) data
-    #define ACCESIO_VMAP_FREE 
-#endif
-
 /*
  * For writing to RAM using a first (hardware) or second (software)
  * stage loader and 0xA0 or 0xA3 vendor requests
@@ -91,28 +75,102 @@ static void accesio_usb_print_dev(accesio_usb_device_info* dev, const char* msg,
     }
 }
 
-static int accesio_usb_bulk_read(accesio_usb_device_info* dev, void* data, uint16_t len)
+/* Makes sure the bounce buffer holds at least len bytes, it only grows so
+ * steady-state transfers allocate nothing. Called with the endpoint's lock held. */
+static int accesio_usb_bounce_reserve(accesio_usb_bounce* bounce, size_t len)
 {
-    int actual_length = 0;
-    int rc = mutex_lock_interruptible(&dev->io_mutex);
-    ACCESIO_VMAP_DATA_DECL
+    void* buffer = NULL;
+    size_t size = 0;
+    if (bounce->buffer != NULL && len <= bounce->size) {
+        ++bounce->reuses;
+        return ACCESIO_SUCCESS;
+    }
+    size = roundup_pow_of_two(max_t(size_t, len, ACCESIO_USB_BUF_SZ));
+    buffer = kmalloc(size, GFP_KERNEL);
+    if (!buffer) { return -ENOMEM; }
+    kfree(bounce->buffer);
+    bounce->buffer = buffer;
+    bounce->size = size;
+    ++bounce->grows;
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_usb_bounce_fill(accesio_usb_bounce* bounce, const void* data, size_t len, bool user)
+{
+    if (len == 0) { return ACCESIO_SUCCESS; }
+    if (user) { return (copy_from_user(bounce->buffer, data, len) != 0) ? -EFAULT : ACCESIO_SUCCESS; }
+    memcpy(bounce->buffer, data, len);
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_usb_bounce_drain(accesio_usb_bounce* bounce, void* data, size_t len, bool user)
+{
+    if (len == 0) { return ACCESIO_SUCCESS; }
+    if (user) { return (copy_to_user(data, bounce->buffer, len) != 0) ? -EFAULT : ACCESIO_SUCCESS; }
+    memcpy(data, bounce->buffer, len);
+    return ACCESIO_SUCCESS;
+}
+
+// a running stream owns its bulk endpoint
+static inline bool accesio_usb_stream_busy(accesio_usb_device_info* dev, bool in)
+{
+    return (in ? READ_ONCE(dev->stream_in.running) : READ_ONCE(dev->stream_out.running));
+}
+
+/* Each endpoint direction has its own lock, so a long bulk read doesn't hold up
+ * a control transfer. All of them also hold io_rwsem shared, which disconnect
+ * takes exclusively, so no transfer starts on a gone device. */
+static int accesio_usb_io_lock(accesio_usb_device_info* dev, accesio_usb_endpoint_info* ep)
+{
+    int rc = mutex_lock_interruptible(&ep->lock);
     if (rc < 0) { return rc; }
+    down_read(&dev->io_rwsem);
     // disconnect() was called
     if (!dev->interface) {
-        mutex_unlock(&dev->io_mutex);
+        up_read(&dev->io_rwsem);
+        mutex_unlock(&ep->lock);
         return -ENODEV;
     }
-    ACCESIO_VMAP_ALLOC(len)
+    return ACCESIO_SUCCESS;
+}
+
+static inline void accesio_usb_io_unlock(accesio_usb_device_info* dev, accesio_usb_endpoint_info* ep)
+{
+    up_read(&dev->io_rwsem);
+    mutex_unlock(&ep->lock);
+}
+
+/*
+ * The synchronous transfers below never hand the caller's memory to the host
+ * controller, it may be on a vmapped stack or in user space (user is true).
+ * The data is copied through the endpoint's bounce buffer instead. The bytes
+ * moved are stored in actual when it isn't NULL, a short transfer still
+ * returns success.
+ */
+
+static int accesio_usb_bulk_read(accesio_usb_device_info* dev, void* data, uint16_t len, bool user, unsigned int timeout_ms, uint32_t* actual)
+{
+    int actual_length = 0;
+    accesio_usb_bounce* bounce = &dev->endpoints.bulk.in.bounce;
+    int rc = 0;
+    if (accesio_usb_stream_busy(dev, true)) { return -EBUSY; }
+    rc = accesio_usb_io_lock(dev, &dev->endpoints.bulk.in);
+    if (rc < 0) { return rc; }
+    rc = accesio_usb_bounce_reserve(bounce, len);
+    if (rc < 0) {
+        accesio_usb_io_unlock(dev, &dev->endpoints.bulk.in);
+        return rc;
+    }
     rc = usb_bulk_msg(dev->udev,                                                    // usb_device
                       usb_rcvbulkpipe(dev->udev, dev->endpoints.bulk.in.address),   // pipe
-                      ACCESIO_VMAP_DATA_REF(data),                                  // data
+                      bounce->buffer,                                               // data
                       len,                                                          // len
                       &actual_length,                                               // xfr/rcv'd
-                      USB_CTRL_SET_TIMEOUT);                                        // timeout
-    ACCESIO_VMAP_COPY_DATA(data, len)
-    ACCESIO_VMAP_FREE
-    mutex_unlock(&dev->io_mutex);
-    if (actual_length == len) {
+                      timeout_ms);                                                  // timeout
+    if (actual_length > 0 && accesio_usb_bounce_drain(bounce, data, actual_length, user) < 0) { rc = -EFAULT; }
+    accesio_usb_io_unlock(dev, &dev->endpoints.bulk.in);
+    if (actual) { *actual = actual_length; }
+    if (actual_length == len && rc >= 0) {
         rc = ACCESIO_SUCCESS;
     } else {
         printk(KERN_INFO KBUILD_MODNAME ": error reading bulk %d, data len = %u, actually sent = %u.\n", rc, len, actual_length);
@@ -120,88 +178,140 @@ static int accesio_usb_bulk_read(accesio_usb_device_info* dev, void* data, uint1
     return rc;
 }
 
-static int accesio_usb_bulk_msg(accesio_usb_device_info* dev, void* data, uint16_t len)
+static int accesio_usb_bulk_msg(accesio_usb_device_info* dev, void* data, uint16_t len, bool user, unsigned int timeout_ms, uint32_t* actual)
 {
     int actual_length = 0;
-    int rc = mutex_lock_interruptible(&dev->io_mutex);
-    ACCESIO_VMAP_DATA_DECL
+    accesio_usb_bounce* bounce = &dev->endpoints.bulk.out.bounce;
+    int rc = 0;
+    if (accesio_usb_stream_busy(dev, false)) { return -EBUSY; }
+    rc = accesio_usb_io_lock(dev, &dev->endpoints.bulk.out);
     if (rc < 0) { return rc; }
-    // disconnect() was called
-    if (!dev->interface) {
-        mutex_unlock(&dev->io_mutex);
-        return -ENODEV;
+    rc = accesio_usb_bounce_reserve(bounce, len);
+    if (rc == ACCESIO_SUCCESS) { rc = accesio_usb_bounce_fill(bounce, data, len, user); }
+    if (rc < 0) {
+        accesio_usb_io_unlock(dev, &dev->endpoints.bulk.out);
+        return rc;
     }
-    dev->ctrl_msg = true;
-    ACCESIO_VMAP_ALLOC(len)
-    ACCESIO_VMAP_DATA_COPY(data, len)
+    atomic_inc(&dev->ctrl_msg);
     rc = usb_bulk_msg(dev->udev,                                                    // usb_device
                       usb_sndbulkpipe(dev->udev, dev->endpoints.bulk.out.address),  // pipe
-                      ACCESIO_VMAP_DATA_REF(data),                                  // data
+                      bounce->buffer,                                               // data
                       len,                                                          // len
                       &actual_length,                                               // xfr/rcv'd
-                      USB_CTRL_SET_TIMEOUT);                                        // timeout
-    ACCESIO_VMAP_FREE
+                      timeout_ms);                                                  // timeout
+    if (actual) { *actual = actual_length; }
     if (actual_length == len) {
         rc = ACCESIO_SUCCESS;
     } else {
         printk(KERN_INFO KBUILD_MODNAME ": error sending bulk %d, data len = %u, actually sent = %u.\n", rc, len, actual_length);
     }
-    dev->ctrl_msg = false;
-    mutex_unlock(&dev->io_mutex);
+    atomic_dec(&dev->ctrl_msg);
+    accesio_usb_io_unlock(dev, &dev->endpoints.bulk.out);
     return rc;
 }
 
-static int accesio_usb_ctrl_read(accesio_usb_device_info* dev, uint8_t request, uint16_t value, uint16_t index, void* data, uint16_t len)
+/* A vendor control transfer through the endpoint's bounce buffer, the lock of
+ * control.in or control.out held. */
+static int accesio_usb_ctrl_transfer(accesio_usb_device_info* dev, bool in, uint8_t request, uint16_t value, uint16_t index, void* data, uint16_t len, bool user)
 {
-    int rc = mutex_lock_interruptible(&dev->io_mutex);
-    ACCESIO_VMAP_DATA_DECL
+    int rc = 0;
+    accesio_usb_endpoint_info* ep = (in ? &dev->endpoints.control.in : &dev->endpoints.control.out);
+    rc = accesio_usb_bounce_reserve(&ep->bounce, len);
+    if (rc == ACCESIO_SUCCESS && !in) { rc = accesio_usb_bounce_fill(&ep->bounce, data, len, user); }
     if (rc < 0) { return rc; }
-    // disconnect() was called
-    if (!dev->interface) {
-        mutex_unlock(&dev->io_mutex);
-        return -ENODEV;
-    }
-    ACCESIO_VMAP_ALLOC(len)
+    if (!in) { atomic_inc(&dev->ctrl_msg); }
     rc = usb_control_msg(dev->udev,                                                      // usb_device
-                         usb_rcvctrlpipe(dev->udev, dev->endpoints.control.in.address),  // pipe
+                         (in ? usb_rcvctrlpipe(dev->udev, ep->address) : usb_sndctrlpipe(dev->udev, ep->address)), // pipe
                          request,                                                        // request 
                          (USB_DIR_OUT | USB_TYPE_VENDOR | USB_RECIP_INTERFACE | USB_RECIP_DEVICE),     // req_type
                          value,                                                         // value
                          index,                                                         // index
-                         ACCESIO_VMAP_DATA_REF(data),                                   // data
+                         ep->bounce.buffer,                                             // data
                          len,                                                           // len
                          USB_CTRL_SET_TIMEOUT);                                         // timeout
-    ACCESIO_VMAP_COPY_DATA(data, len)
-    ACCESIO_VMAP_FREE
-    mutex_unlock(&dev->io_mutex);
+    if (in && rc > 0 && accesio_usb_bounce_drain(&ep->bounce, data, min_t(int, rc, len), user) < 0) { rc = -EFAULT; }
+    if (!in) { atomic_dec(&dev->ctrl_msg); }
     return rc;
 }
 
-static int accesio_usb_ctrl_msg(accesio_usb_device_info* dev, uint8_t request, uint16_t value, uint16_t index, void* data, uint16_t len)
+static int accesio_usb_ctrl_read(accesio_usb_device_info* dev, uint8_t request, uint16_t value, uint16_t index, void* data, uint16_t len, bool user)
 {
-    int rc = mutex_lock_interruptible(&dev->io_mutex);
-    ACCESIO_VMAP_DATA_DECL
+    int rc = accesio_usb_io_lock(dev, &dev->endpoints.control.in);
     if (rc < 0) { return rc; }
-    // disconnect() was called
-    if (!dev->interface) {
-        mutex_unlock(&dev->io_mutex);
-        return -ENODEV;
+    rc = accesio_usb_ctrl_transfer(dev, true, request, value, index, data, len, user);
+    accesio_usb_io_unlock(dev, &dev->endpoints.control.in);
+    return rc;
+}
+
+static int accesio_usb_ctrl_msg(accesio_usb_device_info* dev, uint8_t request, uint16_t value, uint16_t index, void* data, uint16_t len, bool user)
+{
+    int rc = accesio_usb_io_lock(dev, &dev->endpoints.control.out);
+    if (rc < 0) { return rc; }
+    rc = accesio_usb_ctrl_transfer(dev, false, request, value, index, data, len, user);
+    accesio_usb_io_unlock(dev, &dev->endpoints.control.out);
+    return rc;
+}
+
+static enum hrtimer_restart accesio_usb_sg_timeout(struct hrtimer* timer)
+{
+    accesio_usb_endpoint_info* ep = container_of(timer, accesio_usb_endpoint_info, sg_timer);
+    ep->sg_timed_out = true;
+    usb_sg_cancel(ep->sg_request);
+    return HRTIMER_NORESTART;
+}
+
+/* Pins the user buffer and runs the transfer straight from its pages with a
+ * scatter-gather request, so nothing is copied however large it is. Host
+ * controllers without scatter-gather support get one URB per page run. Unless
+ * the controller lifts the constraint, every element but the last must be a
+ * whole number of packets, so a buffer spanning pages has to start at a
+ * packet boundary. */
+static int accesio_usb_bulk_sg(accesio_usb_device_info* dev, accesio_usb_bulk_transfer* transfer)
+{
+    int rc = 0;
+    int pinned = 0;
+    unsigned long address = (unsigned long)transfer->data;
+    unsigned int offset = offset_in_page(address);
+    int count = DIV_ROUND_UP(offset + transfer->length, PAGE_SIZE);
+    bool in = (transfer->direction == ACCESIO_USB_DIR_IN);
+    struct page** pages = NULL;
+    struct sg_table table;
+    struct usb_sg_request request;
+    accesio_usb_endpoint_info* ep = (in ? &dev->endpoints.bulk.in : &dev->endpoints.bulk.out);
+    if (accesio_usb_stream_busy(dev, in)) { return -EBUSY; }
+    if (count > 1 && ep->buffer_size != 0 && (offset % ep->buffer_size) != 0 && !ACCES_SG_UNCONSTRAINED(dev->udev)) { return -EINVAL; }
+    pages = kmalloc_array(count, sizeof(struct page*), GFP_KERNEL);
+    if (!pages) { return -ENOMEM; }
+    // the pages are only written to on a read
+    pinned = ACCES_PIN_USER_PAGES(address, count, in, pages);
+    if (pinned != count) {
+        rc = (pinned < 0) ? pinned : -EFAULT;
+        goto unpin;
     }
-    dev->ctrl_msg = true;
-    ACCESIO_VMAP_ALLOC(len)
-    ACCESIO_VMAP_DATA_COPY(data, len)
-    rc = usb_control_msg(dev->udev,                                                      // usb_device
-                         usb_sndctrlpipe(dev->udev, dev->endpoints.control.out.address), // pipe
-                         request,                                                        // request 
-                         (USB_DIR_OUT | USB_TYPE_VENDOR | USB_RECIP_INTERFACE | USB_RECIP_DEVICE),     // req_type
-                         value,                                                         // value
-                         index,                                                         // index
-                         ACCESIO_VMAP_DATA_REF(data),                                   // data
-                         len,                                                           // len
-                         USB_CTRL_SET_TIMEOUT);                                         // timeout
-    ACCESIO_VMAP_FREE
-    dev->ctrl_msg = false;
-    mutex_unlock(&dev->io_mutex);
+    rc = sg_alloc_table_from_pages(&table, pages, count, offset, transfer->length, GFP_KERNEL);
+    if (rc < 0) { goto unpin; }
+    rc = accesio_usb_io_lock(dev, ep);
+    if (rc < 0) { goto free; }
+    rc = usb_sg_init(&request, dev->udev,
+                     (in ? usb_rcvbulkpipe(dev->udev, ep->address) : usb_sndbulkpipe(dev->udev, ep->address)),
+                     0, table.sgl, table.nents, transfer->length, GFP_KERNEL);
+    if (rc < 0) { goto unlock; }
+    ep->sg_request = &request;
+    ep->sg_timed_out = false;
+    hrtimer_start(&ep->sg_timer, ns_to_ktime((u64)transfer->timeout_ms * 1000000), HRTIMER_MODE_REL);
+    usb_sg_wait(&request);
+    hrtimer_cancel(&ep->sg_timer);
+    ep->sg_request = NULL;
+    transfer->actual_length = request.bytes;
+    // the timer may fire after the transfer completed, which cancels nothing
+    rc = ((ep->sg_timed_out && request.status != 0) ? -ETIMEDOUT : request.status);
+    unlock:
+    accesio_usb_io_unlock(dev, ep);
+    free:
+    sg_free_table(&table);
+    unpin:
+    if (pinned > 0) { ACCES_UNPIN_USER_PAGES(pages, pinned, in); }
+    kfree(pages);
     return rc;
 }
 
@@ -210,7 +320,7 @@ static int accesio_usb_write_ram(ram_poke_context* ctx, unsigned short addr, uns
     int rc = 0;
     unsigned int retry = 0;
     // addr+len should be < 16k
-    if ((addr + len) > 0x4000) {
+    if ((addr + len) > ACCESIO_USB_FW_SIZE) {
         return -EINVAL;
     }
     ctx->total += len;
@@ -218,185 +328,125 @@ static int accesio_usb_write_ram(ram_poke_context* ctx, unsigned short addr, uns
     do {
         // Retry this till we get a real error. Control messages are not
         // NAK'd (just dropped) so time out means is a real problem.
-        rc = accesio_usb_ctrl_msg(ctx->device, ACCESIO_USB_REQ_INT, addr, 0, data, len);
-    } while ((rc < 0) && (++retry < ACCESIO_USB_WRITE_RETRY) && (rc != ETIMEDOUT));
+        rc = accesio_usb_ctrl_msg(ctx->device, ACCESIO_USB_REQ_INT, addr, 0, data, len, false);
+    } while ((rc < 0) && (++retry < ACCESIO_USB_WRITE_RETRY) && (rc != -ETIMEDOUT));
 
     return (rc < 0) ? rc : 0;
 }
 
 /*
- * Parse an Intel HEX image file and invoke the poke() function on the
- * various segments to implement policies such as writing to RAM (with
- * a one or two stage loader setup, depending on the firmware) or to
- * EEPROM (two stages required).
+ * Parses one Intel HEX record of len characters, without the line end, into
+ * the image and marks the bytes it sets as present. Returns 1 for the EOF
+ * record, 0 for a data record, or a negative error.
+ */
+static int accesio_usb_parse_ihex_record(const char* line, size_t len, uint8_t* image, unsigned long* present)
+{
+    uint8_t record[4 + 255 + 1]; // length, address, type, data, checksum
+    uint8_t sum = 0;
+    size_t count = 0;
+    size_t addr = 0;
+    size_t idx = 0;
+    if (line[0] != ':' || len < 11) { // invalid IHEX record
+        return -EINVAL;
+    }
+    if (hex2bin(record, line + 1, 4) < 0) { return -EINVAL; }
+    count = record[0];
+    if ((count * 2) + 11 > len) { // record too short
+        return -ENXIO;
+    }
+    if (hex2bin(record + 4, line + 9, count + 1) < 0) { return -EINVAL; }
+    for (idx = 0; idx < count + 5; ++idx) { sum += record[idx]; }
+    if (sum != 0) {
+        printk(KERN_INFO KBUILD_MODNAME ": bad checksum in FW record %.*s.\n", (int)len, line);
+        return -EINVAL;
+    }
+    // If this is an EOF record, then make it so.
+    if (record[3] == 1) { return 1; }
+    if (record[3] != 0) { // unsupported record type
+        return -EINVAL;
+    }
+    addr = (record[1] << 8) | record[2];
+    if (addr + count > ACCESIO_USB_FW_SIZE) {
+        return -EINVAL;
+    }
+    memcpy(image + addr, record + 4, count);
+    bitmap_set(present, addr, count);
+    return 0;
+}
+
+/*
+ * Parse an Intel HEX image file into a RAM image and write it to the device.
  *
- * image - the hex image file
- * context - for use by poke()
- * is_external - if non-null, used to check which segments go into
- *    external memory (writable only by software loader)
- * poke  - called with each memory segment; errors indicated
- *    by returning negative values.
+ * The whole file is parsed and checked before anything is sent, so a bad
+ * image leaves the device untouched. Records set bytes of the image, which
+ * is then sent as its contiguous runs in ACCESIO_USB_FW_CHUNK transfers
+ * rather than one transfer per few records. A transfer never crosses from
+ * on-chip into external RAM (on the FX2 0x1F00-0x2100 is not physically
+ * contiguous although its addresses are).
  *
  * Caller is responsible for halting CPU as needed, such as when
  * overwriting a second stage loader.
  */
 static int accessio_parse_and_send_ihex(const uint8_t* sdata, size_t slen, accesio_usb_device_info* udev)
 {
-    const size_t BUF_SZ = ACCESIO_USB_BUF_SZ; // udev->endpoints.control.out.buffer_size;
-    const size_t DATA_SZ = (BUF_SZ * 2) - 1;
     ram_poke_context context;
-    unsigned char* data = kzalloc(DATA_SZ, GFP_KERNEL);
-    char* buf = kzalloc(BUF_SZ, GFP_KERNEL);
-    unsigned short data_addr = 0;
-    size_t data_len = 0;
-    size_t pos = 0;
-    int rc;
-    int first_line = 1;
-
-    memset(data, 0, DATA_SZ);
+    uint8_t* image = kzalloc(ACCESIO_USB_FW_SIZE, GFP_KERNEL);
+    unsigned long* present = kcalloc(BITS_TO_LONGS(ACCESIO_USB_FW_SIZE), sizeof(unsigned long), GFP_KERNEL);
+    const char* line = (const char*)sdata;
+    const char* end = NULL;
+    size_t left = slen;
+    size_t len = 0;
+    unsigned long start = 0;
+    unsigned long stop = 0;
+    unsigned long addr = 0;
+    int rc = -EFAULT;
+
     context.mode = internal_only;
     context.device = udev;
     context.total = 0;
     context.count = 0;
+    if (!image || !present) {
+        rc = -ENOMEM;
+        goto error;
+    }
 
-    /* Read the input file as an IHEX file, and report the memory segments
-     * as we go.  Each line holds a max of 16 bytes, but downloading is
-     * faster (and EEPROM space smaller) if we merge those lines into larger
-     * chunks.  Most hex files keep memory segments together, which makes
-     * such merging all but free.  (But it may still be worth sorting the
-     * hex files to make up for undesirable behavior from tools.)
-     *
-     * Note that EEPROM segments max out at 1023 bytes; the download protocol
-     * allows segments of up to 64 KBytes (more than a loader could handle).
-     */
-    for (;;) {
-        size_t len = 0;
-        size_t idx = 0;
-        size_t off = 0;
-        size_t type = 0;
-        char* cp = NULL;
-        char tmp = 0;
-        memset(buf, 0, BUF_SZ);
-
-        // cp = fgets(buf, sizeof buf, image);
-        for (len = 0; len < BUF_SZ && pos < slen; ++len, ++pos) {
-            idx = len;
-            buf[len] = sdata[pos];
-            if (buf[len] == '\n') {
-                buf[len] = 0;
-                ++pos;
-                break;
-            }
-            if (buf[len] == '\0') {
-                printk(KERN_INFO KBUILD_MODNAME ": EOF w/o EOF record found in FW @ pos = %zu with len = %zu.\n", pos, len);
-                rc = -EFAULT;
-                goto error;
-            }
-        }
-        if (idx == 0) {
-            // EOF w/o EOF record
-            printk(KERN_INFO KBUILD_MODNAME ": EOF w/o EOF record found in FW @ pos = %zu.\n", pos);
-            rc = -EFAULT;
-            goto error;
-        }
-
+    while (left != 0) {
+        end = memchr(line, '\n', left);
+        len = (end ? (size_t)(end - line) : left);
+        left -= (end ? len + 1 : len);
+        if (len != 0 && line[len - 1] == '\r') { --len; }
+        if (memchr(line, '\0', len)) { break; }
         // EXTENSION: "# comment-till-end-of-line", for copyrights etc
-        if (buf[0] == '#') { continue; }
-        if (buf[0] != ':') { // invalid IHEX record
-            rc = -EINVAL;
-            goto error;
-        }
-
-        // this is done in the for loop
-        /* ignore any newline
-        cp = strchr(buf, '\n');
-        if (cp) { *cp = 0; } */
-
-        // Read the length field (up to 16 bytes)
-        tmp = buf[3];
-        buf[3] = 0;
-        //len = strtoul(buf+1, 0, 16);
-        rc = kstrtoul(buf+1, 16, &len);
-        if (rc < 0) {
-            goto error;
-        }
-        buf[3] = tmp;
-        // Read the target offset (address up to 64KB)
-        tmp = buf[7];
-        buf[7] = 0;
-        //off = strtoul(buf+3, 0, 16);
-        rc = kstrtoul(buf+3, 16, &off);
-        if (rc < 0) {
-            goto error;
-        }
-        buf[7] = tmp;
-        // Initialize data_addr
-        if (first_line) {
-            data_addr = off;
-            first_line = 0;
-        }
-        // Read the record type
-        tmp = buf[9];
-        buf[9] = 0;
-        //type = strtoul(buf+7, 0, 16);
-        rc = kstrtoul(buf+7, 16, &type);
-        if (rc < 0) {
-            goto error;
-        }
-        buf[9] = tmp;
-
-        // If this is an EOF record, then make it so.
-        if (type == 1) { break; }
-        if (type != 0) { // unsupported record type
-            rc = -EINVAL;
-            goto error;
-        }
-        
-        if ((len * 2) + 11 > strnlen(buf, BUF_SZ)) { // record too short
-            rc = -ENXIO;
-            goto error;
-        }
-
-        /* FIXME check for _physically_ contiguous not just virtually
-        e.g. on FX2 0x1F00-0x2100 includes both on-chip and external
-        memory so it's not really contiguous */
-
-        // flush the saved data if it's not contiguous, or when we've buffered as much as we can.
-        if ((data_len != 0) && (off != (data_addr + data_len) || ((data_len + len) > DATA_SZ))) {
-            rc = accesio_usb_write_ram(&context, data_addr, data, data_len);
-            if (rc < 0) {
-                goto error;
-            }
-            data_addr = off;
-            data_len = 0;
-        }
-        // append to saved data, flush later
-        for (idx = 0, cp = buf+9; idx < len; ++idx, cp += 2) {
-            tmp = cp[2];
-            cp[2] = 0;
-            //data[data_len + idx] = strtoul(cp, 0, 16);
-            rc = kstrtoul(cp, 16, &off);
-            if (rc < 0) {
-                goto error;
-            }
-            data[data_len + idx] = off;
-            cp[2] = tmp;
+        if (len != 0 && line[0] != '#') {
+            rc = accesio_usb_parse_ihex_record(line, len, image, present);
+            if (rc < 0) { goto error; }
+            if (rc == 1) { break; }
+            rc = -EFAULT;
         }
-        data_len += len;
+        line = (end ? end + 1 : line + len);
+    }
+    if (rc != 1) {
+        // EOF w/o EOF record
+        printk(KERN_INFO KBUILD_MODNAME ": EOF w/o EOF record found in FW @ pos = %zu.\n", slen - left);
+        rc = -EFAULT;
+        goto error;
     }
 
-    // flush any data remaining
-    if (data_len != 0) {
-        rc =  accesio_usb_write_ram(&context, data_addr, data, data_len);
-        if (rc < 0) {
-            goto error;
+    for (start = find_next_bit(present, ACCESIO_USB_FW_SIZE, 0); start < ACCESIO_USB_FW_SIZE; start = find_next_bit(present, ACCESIO_USB_FW_SIZE, stop)) {
+        stop = find_next_zero_bit(present, ACCESIO_USB_FW_SIZE, start);
+        for (addr = start; addr < stop; addr += len) {
+            len = min_t(unsigned long, stop - addr, ACCESIO_USB_FW_CHUNK);
+            if (addr < ACCESIO_USB_FW_EXTERNAL && addr + len > ACCESIO_USB_FW_EXTERNAL) { len = ACCESIO_USB_FW_EXTERNAL - addr; }
+            rc = accesio_usb_write_ram(&context, addr, image + addr, len);
+            if (rc < 0) { goto error; }
         }
     }
+    printk(KERN_INFO KBUILD_MODNAME ": firmware image of %u bytes sent in %u transfers.\n", context.total, context.count);
     rc = 0;
-    
+
     error:
-    kfree(data);
-    kfree(buf);
+    kfree(image);
+    kfree(present);
     return rc;
 }
 
@@ -407,7 +457,7 @@ static int accessio_parse_and_send_ihex(const uint8_t* sdata, size_t slen, acces
 static int accesio_usb_set_cpu_runstate(accesio_usb_device_info* device, bool run)
 {
     unsigned char data = run ? 0 : 1;
-    int rc = accesio_usb_ctrl_msg(device, ACCESIO_USB_REQ_INT, ACCESIO_USB_RAM_REG, 0, &data, 1);
+    int rc = accesio_usb_ctrl_msg(device, ACCESIO_USB_REQ_INT, ACCESIO_USB_RAM_REG, 0, &data, 1, false);
     if (rc < 1) {
         printk(KERN_INFO KBUILD_MODNAME ": error modifying run state %d.\n", rc);
         return rc;
@@ -463,6 +513,8 @@ static void accesio_usb_free_endpoint_info(accesio_usb_endpoint* ep)
     if (ep->out.urb) { usb_free_urb(ep->out.urb); }
     if (ep->in.buffer) { kfree(ep->in.buffer); }
     if (ep->out.buffer) { kfree(ep->out.buffer); }
+    kfree(ep->in.bounce.buffer);
+    kfree(ep->out.bounce.buffer);
 }
 
 static int accesio_usb_set_endpoint_info(accesio_usb_endpoint* ep, struct usb_endpoint_descriptor* in, struct usb_endpoint_descriptor* out, const char* epname)
@@ -478,6 +530,7 @@ static int accesio_usb_set_endpoint_info(accesio_usb_endpoint* ep, struct usb_en
         ep->out.buffer_size = ACCESIO_USB_BUF_SZ;
         if (in) {
             ep->in.address = in->bEndpointAddress;
+            ep->in.interval = in->bInterval;
             ep->in.buffer_size = usb_endpoint_maxp(in);
             ep->in.buffer = kmalloc(ep->in.buffer_size, GFP_KERNEL);
             if (!ep->in.buffer) {
@@ -492,6 +545,7 @@ static int accesio_usb_set_endpoint_info(accesio_usb_endpoint* ep, struct usb_en
         }
         if (out) {
             ep->out.address = out->bEndpointAddress;
+            ep->out.interval = out->bInterval;
             ep->out.buffer_size = usb_endpoint_maxp(out);
             ep->out.buffer = kmalloc(ep->out.buffer_size, GFP_KERNEL);
             if (!ep->out.buffer) {
@@ -635,154 +689,893 @@ static int accesio_usb_setup_endpoints(accesio_usb_device_info* dev)
     ret = accesio_usb_set_endpoint_info(&dev->endpoints.control, ctrl_in, ctrl_out, "control");
     ret = accesio_usb_set_endpoint_info(&dev->endpoints.isochronous, iso_in, iso_out, "isochronous");
     ret = accesio_usb_set_endpoint_info(&dev->endpoints.interrupt, int_in, int_out, "interrupt");
+    // size the bounce buffers of the synchronous transfers for a full packet up front
+    if (accesio_usb_bounce_reserve(&dev->endpoints.bulk.in.bounce, dev->endpoints.bulk.in.buffer_size) < 0 ||
+        accesio_usb_bounce_reserve(&dev->endpoints.bulk.out.bounce, dev->endpoints.bulk.out.buffer_size) < 0 ||
+        accesio_usb_bounce_reserve(&dev->endpoints.control.in.bounce, dev->endpoints.control.in.buffer_size) < 0 ||
+        accesio_usb_bounce_reserve(&dev->endpoints.control.out.bounce, dev->endpoints.control.out.buffer_size) < 0)
+    {
+        return -ENOMEM;
+    }
     return ACCESIO_SUCCESS;
 }
 
-static char* accesio_usb_get_devnode(struct device* dev, umode_t* mode)
+static void accesio_usb_async_callback(struct urb* purb)
 {
-    return kasprintf(GFP_KERNEL,
-                     DRIVER_CLASS_NAME"/%s_%u",
-                     dev_name(dev), MINOR(dev->devt));
+    unsigned long flags;
+    accesio_usb_async* async = purb->context;
+    accesio_usb_device_info* dev = async->dev;
+    spin_lock_irqsave(&dev->async_lock, flags);
+    async->request.status = purb->status;
+    async->request.actual_length = purb->actual_length;
+    list_move_tail(&async->list, &dev->async_done);
+    spin_unlock_irqrestore(&dev->async_lock, flags);
+    wake_up_interruptible(&dev->async_wait);
 }
 
-static void accesio_usb_delete(struct kref* kobj)
+static void accesio_usb_async_free(accesio_usb_device_info* dev, accesio_usb_async* async)
 {
-    accesio_usb_device_info* dev = container_of(kobj, accesio_usb_device_info, kref);
-    decrement_device_id(dev->product_id);
-    --accesio_found_devices;
-    accesio_usb_print_dev(dev, "unregistering device ", false);
-    if (dev->interface != NULL) {
-        usb_set_intfdata(dev->interface, NULL);
-        // give back our minor
-        usb_deregister_dev(dev->interface, &accesio_usb_class);
-        // prevent more I/O from starting
-        mutex_lock(&dev->io_mutex);
-        dev->interface = NULL;
-        mutex_unlock(&dev->io_mutex);
-        usb_kill_anchored_urbs(&dev->submitted);
-    }
-    mutex_destroy(&dev->io_mutex);
-    accesio_usb_free_endpoint_info(&dev->endpoints.bulk);
-    accesio_usb_free_endpoint_info(&dev->endpoints.control);
-    accesio_usb_free_endpoint_info(&dev->endpoints.isochronous);
-    accesio_usb_free_endpoint_info(&dev->endpoints.interrupt);
-    usb_put_dev(dev->udev);
-    kfree(dev);
+    unsigned long flags;
+    spin_lock_irqsave(&dev->async_lock, flags);
+    --dev->async_count;
+    spin_unlock_irqrestore(&dev->async_lock, flags);
+    kfree(async->urb->transfer_buffer);
+    usb_free_urb(async->urb);
+    kfree(async);
 }
 
-static int accesio_usb_open(struct inode* inode, struct file* filp)
+// the oldest transfer on list submitted through filp, async_lock held
+static accesio_usb_async* accesio_usb_async_find(struct list_head* list, struct file* filp)
 {
-    accesio_usb_device_info* dev;
-    int tmp = iminor(inode);
-    struct usb_interface* interface = usb_find_interface(&accesio_usb_driver, tmp);
-    if (!interface) {
-        printk(KERN_INFO KBUILD_MODNAME ": error finding device for minor %d.\n", tmp);
-        return -ENODEV;
-    }
-    dev = usb_get_intfdata(interface);
-    if (!dev) {
-        printk(KERN_INFO KBUILD_MODNAME ": error retrieving interface data.\n");
-        return -ENODEV;
+    accesio_usb_async* async = NULL;
+    list_for_each_entry(async, list, list) {
+        if (async->owner == filp) { return async; }
     }
-    #if defined(CONFIG_PM) || defined(ACCESIO_USB_AUTOSUSPEND)
-        tmp = usb_autopm_get_interface(interface);
-        if (tmp != 0) {
-            printk(KERN_INFO KBUILD_MODNAME ": error retrieving PM interface data %d.\n", tmp);
-            return tmp;
-        }
-    #endif
-    // increment our usage count for the device
-    kref_get(&dev->kref);
-    // save our object in the file's private structure
-    filp->private_data = dev;
-    return ACCESIO_SUCCESS;
+    return NULL;
 }
 
-static int accesio_usb_release(struct inode* inode, struct file* filp)
+// a transfer of filp can be reaped, or none is left in flight to wait on
+static bool accesio_usb_async_ready(accesio_usb_device_info* dev, struct file* filp)
 {
-    accesio_usb_device_info* dev = filp->private_data;
-    if (dev == NULL) { return -ENODEV; }
-    #if defined(CONFIG_PM) || defined(ACCESIO_USB_AUTOSUSPEND)
-        // allow the device to be autosuspended
-        mutex_lock(&dev->io_mutex);
-        if (dev->interface) {
-            usb_autopm_put_interface(dev->interface);
-        }
-        mutex_unlock(&dev->io_mutex);
-    #endif
-    // decrement the count on our device
-    kref_put(&dev->kref, accesio_usb_delete);
-    return ACCESIO_SUCCESS;
+    bool ready = false;
+    spin_lock_irq(&dev->async_lock);
+    ready = (accesio_usb_async_find(&dev->async_done, filp) != NULL || accesio_usb_async_find(&dev->async_pending, filp) == NULL);
+    spin_unlock_irq(&dev->async_lock);
+    return ready;
 }
 
-static int accesio_usb_flush(struct file* filp, fl_owner_t id)
+// kills the transfers filp has in flight, they complete onto async_done
+static void accesio_usb_async_kill(accesio_usb_device_info* dev, struct file* filp)
 {
-    int res = 0;
-    accesio_usb_device_info* dev = filp->private_data;
-    if (dev == NULL) { return -ENODEV; }
-    // wait for io to stop
-    mutex_lock(&dev->io_mutex);
-    accesio_usb_draw_down(dev);
-    // read out errors, leave subsequent opens in a clean slate
-    spin_lock_irq(&dev->err_lock);
-    if (dev->errors) {
-        res = (dev->errors == -EPIPE ? -EPIPE : -EIO);
+    struct urb* urb = NULL;
+    accesio_usb_async* async = NULL;
+    for (;;) {
+        urb = NULL;
+        spin_lock_irq(&dev->async_lock);
+        list_for_each_entry(async, &dev->async_pending, list) {
+            if (async->owner == filp && !async->killed) {
+                async->killed = true;
+                urb = usb_get_urb(async->urb);
+                break;
+            }
+        }
+        spin_unlock_irq(&dev->async_lock);
+        if (urb == NULL) { break; }
+        usb_kill_urb(urb);
+        usb_free_urb(urb);
     }
-    dev->errors = 0;
-    spin_unlock_irq(&dev->err_lock);
-    mutex_unlock(&dev->io_mutex);
-    return res;
 }
 
-static void accesio_usb_read_bulk_callback(struct urb* purb)
+/* Drops the completed transfers of filp nobody reaped, or those of every file
+ * when filp is NULL. The URBs must have been drawn down. */
+static void accesio_usb_async_free_done(accesio_usb_device_info* dev, struct file* filp)
 {
-    unsigned long flags;
-    accesio_usb_device_info* dev = purb->context;
-    spin_lock_irqsave(&dev->err_lock, flags);
-    if (purb->status) {
-        // sync/async unlink faults aren't errors
-        if (!(purb->status == -ENOENT || purb->status == -ECONNRESET || purb->status == -ESHUTDOWN)) {
-            printk(KERN_INFO KBUILD_MODNAME ": non-zero write bulk status received %d.\n", purb->status);
+    accesio_usb_async* async = NULL;
+    for (;;) {
+        spin_lock_irq(&dev->async_lock);
+        if (filp == NULL) {
+            async = list_first_entry_or_null(&dev->async_done, accesio_usb_async, list);
+        } else {
+            async = accesio_usb_async_find(&dev->async_done, filp);
         }
-        dev->errors = purb->status;
-    } else {
-        dev->endpoints.bulk.in.filled = purb->actual_length;
+        if (async != NULL) { list_del(&async->list); }
+        spin_unlock_irq(&dev->async_lock);
+        if (async == NULL) { break; }
+        accesio_usb_async_free(dev, async);
     }
-    dev->ongoing_read = 0;
-    spin_unlock_irqrestore(&dev->err_lock, flags);
-    wake_up_interruptible(&dev->io_wait);
 }
 
-static int accesio_usb_do_read_io(accesio_usb_device_info* dev, size_t count)
+/*
+ * Streams keep urb_count URBs queued on one bulk endpoint and move the data
+ * through a ring of ring_size bytes. The ring has one producer and one
+ * consumer, head and tail run freely and only their owner writes them. On
+ * input the completions produce under urb_lock and the reader consumes under
+ * io_lock, on output the writer produces under io_lock and the completions
+ * consume under urb_lock. The ring follows a control page holding both
+ * indices, an input ring can be mapped by the application, which then
+ * consumes by advancing the tail itself. So the tail is never trusted, the
+ * fill it gives is clamped to the ring, and the driver keeps its own head.
+ * Output URBs that find the ring empty wait in idle until the writer brings
+ * more data. URBs are only (re)submitted under urb_lock so they reach the
+ * endpoint in the order of the data.
+ */
+
+static inline bool accesio_usb_stream_killed(int status)
 {
-    int rv = 0;
-    // prepare a read
-    usb_fill_bulk_urb(dev->endpoints.bulk.in.urb,
-                      dev->udev,
-                      usb_rcvbulkpipe(dev->udev, dev->endpoints.bulk.in.address),
-                      dev->endpoints.bulk.in.buffer,
-                      min(dev->endpoints.bulk.in.buffer_size, count),
-                      accesio_usb_read_bulk_callback,
-                      dev);
+    return (status == -ENOENT || status == -ECONNRESET || status == -ESHUTDOWN || status == -ENODEV);
+}
 
+// bytes in the ring, stream->control must be allocated
+static inline uint32_t accesio_usb_stream_used(accesio_usb_stream* stream)
+{
+    return min(smp_load_acquire(&stream->head) - smp_load_acquire(&stream->control->tail), stream->ring_size);
+}
 
-    // tell everybody to leave the URB alone
-    spin_lock_irq(&dev->err_lock);
-    dev->ongoing_read = 1;
-    spin_unlock_irq(&dev->err_lock);
-    // submit bulk in urb, which means no data to deliver
-    dev->endpoints.bulk.in.filled = 0;
-    dev->endpoints.bulk.in.copied = 0;
-    // do it
-    rv = usb_submit_urb(dev->endpoints.bulk.in.urb, GFP_KERNEL);
-    if (rv < 0) {
-        // dev_err(&dev->interface->dev, "%s - failed submitting read urb, error %d\n", __func__, rv);
-        printk(KERN_INFO KBUILD_MODNAME ": error submitting read urb, %d.\n", rv);
-        if (rv != -ENOMEM) { rv = -EIO; }
-        spin_lock_irq(&dev->err_lock);
+// makes the data up to head visible to the consumer
+static inline void accesio_usb_stream_publish(accesio_usb_stream* stream, uint32_t head)
+{
+    smp_store_release(&stream->head, head);
+    smp_store_release(&stream->control->head, head);
+}
+
+// bytes in the ring, 0 without one, for callers that don't hold the ring
+static uint32_t accesio_usb_stream_fill(accesio_usb_stream* stream)
+{
+    uint32_t used = 0;
+    mutex_lock(&stream->lock);
+    if (stream->control) { used = accesio_usb_stream_used(stream); }
+    mutex_unlock(&stream->lock);
+    return used;
+}
+
+static void accesio_usb_stream_init(accesio_usb_stream* stream)
+{
+    init_usb_anchor(&stream->anchor);
+    mutex_init(&stream->lock);
+    mutex_init(&stream->io_lock);
+    spin_lock_init(&stream->urb_lock);
+    init_waitqueue_head(&stream->wait);
+    atomic_set(&stream->mapped, 0);
+}
+
+// a stall needs the endpoint cleared, that can't be done from a completion
+static inline bool accesio_usb_stream_fatal(int status)
+{
+    return (accesio_usb_stream_killed(status) || status == -EPIPE);
+}
+
+// urb_lock held, a URB that can't be resubmitted ends the stream
+static void accesio_usb_stream_resubmit(accesio_usb_stream* stream, struct urb* purb)
+{
+    int rc = 0;
+    usb_anchor_urb(purb, &stream->anchor);
+    rc = usb_submit_urb(purb, GFP_ATOMIC);
+    if (rc < 0) {
+        usb_unanchor_urb(purb);
+        printk(KERN_INFO KBUILD_MODNAME ": error resubmitting stream urb %d.\n", rc);
+        ++stream->errors;
+        stream->error = rc;
+        stream->running = false;
+    }
+}
+
+// counts the completion, urb_lock held
+static void accesio_usb_stream_account(accesio_usb_stream* stream, struct urb* purb)
+{
+    if (purb->status == 0) {
+        ++stream->urbs_done;
+    } else if (!accesio_usb_stream_killed(purb->status)) {
+        ++stream->errors;
+        printk(KERN_INFO KBUILD_MODNAME ": non-zero stream bulk status received %d.\n", purb->status);
+    }
+    if (stream->running && accesio_usb_stream_fatal(purb->status)) {
+        stream->error = purb->status;
+        stream->running = false;
+    }
+}
+
+// notes a completion for the clock estimate, urb_lock held
+static void accesio_usb_clock_add(accesio_usb_clock* clock, uint64_t offset, uint64_t ns)
+{
+    clock->offset[clock->next] = offset;
+    clock->ns[clock->next] = ns;
+    clock->next = (clock->next + 1) % ACCESIO_USB_CLOCK_POINTS;
+    if (clock->count < ACCESIO_USB_CLOCK_POINTS) { ++clock->count; }
+}
+
+// copies into the ring at head, returns the new head, the space must be there
+static uint32_t accesio_usb_stream_copy_in(accesio_usb_stream* stream, uint32_t head, const void* data, uint32_t len)
+{
+    uint32_t first = min(len, stream->ring_size - (head & (stream->ring_size - 1)));
+    memcpy(stream->ring + (head & (stream->ring_size - 1)), data, first);
+    memcpy(stream->ring, (const uint8_t*)data + first, len - first);
+    return head + len;
+}
+
+// copies out of the ring at tail without consuming
+static void accesio_usb_stream_peek(accesio_usb_stream* stream, uint32_t tail, void* data, uint32_t len)
+{
+    uint32_t first = min(len, stream->ring_size - (tail & (stream->ring_size - 1)));
+    memcpy(data, stream->ring + (tail & (stream->ring_size - 1)), first);
+    memcpy((uint8_t*)data + first, stream->ring, len - first);
+}
+
+// copies out of the ring at tail to user space without consuming, non-zero on a fault
+static int accesio_usb_stream_copy_out(accesio_usb_stream* stream, uint32_t tail, char* buffer, uint32_t len)
+{
+    uint32_t first = min(len, stream->ring_size - (tail & (stream->ring_size - 1)));
+    return (copy_to_user(buffer, stream->ring + (tail & (stream->ring_size - 1)), first) ||
+            copy_to_user(buffer + first, stream->ring, len - first));
+}
+
+static void accesio_usb_stream_in_callback(struct urb* purb)
+{
+    unsigned long flags;
+    uint32_t head, space, len;
+    uint64_t now = ktime_get_ns();
+    accesio_usb_stream_timestamp stamp;
+    accesio_usb_device_info* dev = purb->context;
+    accesio_usb_stream* stream = &dev->stream_in;
+    spin_lock_irqsave(&stream->urb_lock, flags);
+    accesio_usb_stream_account(stream, purb);
+    if (purb->status == 0) {
+        head = stream->head;
+        space = stream->ring_size - accesio_usb_stream_used(stream);
+        len = purb->actual_length;
+        // the clock's offsets, everything the device sent
+        stamp.offset = stream->bytes + stream->overruns;
+        // the reader fell behind, whatever doesn't fit is lost
+        if (len > space) {
+            stream->overruns += (len - space);
+            WRITE_ONCE(stream->control->overruns, stream->overruns);
+            len = space;
+        }
+        accesio_usb_stream_publish(stream, accesio_usb_stream_copy_in(stream, head, purb->transfer_buffer, len));
+        stamp.timestamp_ns = now;
+        stamp.position = stream->bytes;
+        stamp.length = len;
+        stamp.dropped = purb->actual_length - len;
+        if (!kfifo_put(&stream->stamps, stamp)) { ++stream->stamps_dropped; }
+        stream->bytes += len;
+        accesio_usb_clock_add(&stream->clock, stream->bytes + stream->overruns, now);
+    }
+    if (stream->running) { accesio_usb_stream_resubmit(stream, purb); }
+    spin_unlock_irqrestore(&stream->urb_lock, flags);
+    wake_up_interruptible(&stream->wait);
+}
+
+/* Stores a record per packet, its header and data padded to 8 bytes. The
+ * packets were received interval apart, the last one at completion. A packet
+ * that doesn't fit the ring is dropped whole, which leaves a sequence gap. */
+static void accesio_usb_stream_iso_callback(struct urb* purb)
+{
+    int i = 0;
+    unsigned long flags;
+    uint32_t head, used, stride;
+    uint64_t now = ktime_get_ns();
+    accesio_usb_iso_packet packet;
+    struct usb_iso_packet_descriptor* frame = NULL;
+    accesio_usb_device_info* dev = purb->context;
+    accesio_usb_stream* stream = &dev->stream_iso;
+    spin_lock_irqsave(&stream->urb_lock, flags);
+    accesio_usb_stream_account(stream, purb);
+    if (purb->status == 0) {
+        head = stream->head;
+        used = min(head - smp_load_acquire(&stream->control->tail), stream->ring_size);
+        for (i = 0; i < purb->number_of_packets; ++i) {
+            frame = &purb->iso_frame_desc[i];
+            packet.timestamp_ns = now - ((uint64_t)(purb->number_of_packets - 1 - i) * stream->period_ns);
+            packet.frame = purb->start_frame + (i * purb->interval);
+            packet.status = frame->status;
+            packet.length = frame->actual_length;
+            packet.sequence = stream->sequence++;
+            stride = sizeof(accesio_usb_iso_packet) + ALIGN(packet.length, 8);
+            if (stride > stream->ring_size - used) {
+                stream->overruns += packet.length;
+                WRITE_ONCE(stream->control->overruns, stream->overruns);
+                continue;
+            }
+            head = accesio_usb_stream_copy_in(stream, head, &packet, sizeof(accesio_usb_iso_packet));
+            accesio_usb_stream_copy_in(stream, head, (uint8_t*)purb->transfer_buffer + frame->offset, packet.length);
+            head += ALIGN(packet.length, 8);
+            used += stride;
+            stream->bytes += packet.length;
+        }
+        accesio_usb_stream_publish(stream, head);
+    }
+    if (stream->running) { accesio_usb_stream_resubmit(stream, purb); }
+    spin_unlock_irqrestore(&stream->urb_lock, flags);
+    wake_up_interruptible(&stream->wait);
+}
+
+// moves up to urb_size bytes from the ring into an output URB, urb_lock held
+static uint32_t accesio_usb_stream_out_fill(accesio_usb_stream* stream, struct urb* purb)
+{
+    uint32_t tail = stream->control->tail;
+    uint32_t len = min(accesio_usb_stream_used(stream), stream->urb_size);
+    uint32_t first = min(len, stream->ring_size - (tail & (stream->ring_size - 1)));
+    memcpy(purb->transfer_buffer, stream->ring + (tail & (stream->ring_size - 1)), first);
+    memcpy((uint8_t*)purb->transfer_buffer + first, stream->ring, len - first);
+    purb->transfer_buffer_length = len;
+    smp_store_release(&stream->control->tail, tail + len);
+    return len;
+}
+
+static void accesio_usb_stream_out_callback(struct urb* purb)
+{
+    unsigned long flags;
+    accesio_usb_device_info* dev = purb->context;
+    accesio_usb_stream* stream = &dev->stream_out;
+    bool wake = false;
+    spin_lock_irqsave(&stream->urb_lock, flags);
+    accesio_usb_stream_account(stream, purb);
+    if (purb->status == 0) {
+        stream->bytes += purb->actual_length;
+        accesio_usb_clock_add(&stream->clock, stream->bytes, ktime_get_ns());
+    }
+    if (stream->running) {
+        if (accesio_usb_stream_out_fill(stream, purb) > 0) {
+            accesio_usb_stream_resubmit(stream, purb);
+        } else {
+            stream->idle[stream->idle_count++] = purb;
+            // nothing left in flight, the device is starved
+            if (stream->idle_count == stream->urb_count) { ++stream->underruns; }
+        }
+    }
+    wake = (!stream->running || accesio_usb_stream_used(stream) <= stream->low_water);
+    spin_unlock_irqrestore(&stream->urb_lock, flags);
+    if (wake) { wake_up_interruptible(&stream->wait); }
+}
+
+// hands the data the writer just queued to the idle output URBs
+static void accesio_usb_stream_out_kick(accesio_usb_stream* stream)
+{
+    struct urb* purb = NULL;
+    spin_lock_irq(&stream->urb_lock);
+    while (stream->running && stream->idle_count > 0 && accesio_usb_stream_used(stream) != 0) {
+        purb = stream->idle[--stream->idle_count];
+        accesio_usb_stream_out_fill(stream, purb);
+        accesio_usb_stream_resubmit(stream, purb);
+    }
+    spin_unlock_irq(&stream->urb_lock);
+}
+
+// kills and frees the URBs, the ring stays so what's left can still be read
+static void accesio_usb_stream_stop(accesio_usb_device_info* dev, accesio_usb_stream* stream)
+{
+    uint32_t i = 0;
+    struct urb* purb = NULL;
+    spin_lock_irq(&stream->urb_lock);
+    stream->running = false;
+    stream->idle_count = 0;
+    spin_unlock_irq(&stream->urb_lock);
+    usb_kill_anchored_urbs(&stream->anchor);
+    for (i = 0; i < ACCESIO_USB_STREAM_URBS_MAX; ++i) {
+        purb = stream->urbs[i];
+        if (purb == NULL) { continue; }
+        if (purb->transfer_buffer) {
+            usb_free_coherent(dev->udev, stream->urb_size, purb->transfer_buffer, purb->transfer_dma);
+        }
+        usb_free_urb(purb);
+        stream->urbs[i] = NULL;
+    }
+    wake_up_interruptible(&stream->wait);
+}
+
+// stops the isochronous stream and gives its bandwidth back, stream->lock held
+static void accesio_usb_iso_stop(accesio_usb_device_info* dev)
+{
+    accesio_usb_stream* stream = &dev->stream_iso;
+    accesio_usb_stream_stop(dev, stream);
+    if (stream->altsetting == 0) { return; }
+    down_read(&dev->io_rwsem);
+    if (dev->interface) {
+        usb_set_interface(dev->udev, dev->interface->cur_altsetting->desc.bInterfaceNumber, 0);
+    }
+    up_read(&dev->io_rwsem);
+    stream->altsetting = 0;
+}
+
+/* Stops the stream and frees its ring when filp started it, or always when
+ * filp is NULL. A ring another file still has mapped is left for the next
+ * start or the device's removal. */
+static void accesio_usb_stream_release(accesio_usb_device_info* dev, accesio_usb_stream* stream, struct file* filp)
+{
+    mutex_lock(&stream->lock);
+    if (filp != NULL && stream->owner != filp) {
+        mutex_unlock(&stream->lock);
+        return;
+    }
+    if (stream == &dev->stream_iso) {
+        accesio_usb_iso_stop(dev);
+    } else {
+        accesio_usb_stream_stop(dev, stream);
+    }
+    stream->owner = NULL;
+    if (filp == NULL || atomic_read(&stream->mapped) == 0) {
+        mutex_lock(&stream->io_lock);
+        vfree(stream->control);
+        stream->control = NULL;
+        stream->ring = NULL;
+        stream->ring_size = 0;
+        stream->head = 0;
+        mutex_unlock(&stream->io_lock);
+    }
+    mutex_unlock(&stream->lock);
+}
+
+/* Checks the configuration against the endpoint's packet size, applies the
+ * defaults and sets up a fresh ring and URB set, stream->lock held. */
+static int accesio_usb_stream_alloc(accesio_usb_device_info* dev, accesio_usb_stream* stream, accesio_usb_stream_config* config, size_t packet, bool iso)
+{
+    uint32_t i = 0;
+    uint8_t* buffer = NULL;
+    if (config->urb_count == 0) { config->urb_count = ACCESIO_USB_STREAM_URBS_DEFAULT; }
+    if (config->urb_size == 0) { config->urb_size = ACCESIO_USB_STREAM_URB_SIZE_DEFAULT; }
+    if (config->urb_count > ACCESIO_USB_STREAM_URBS_MAX || config->urb_size > ACCESIO_USB_STREAM_URB_SIZE_MAX) { return -EINVAL; }
+    if (packet == 0 || (config->urb_size % packet) != 0) { return -EINVAL; }
+    if (iso && (config->urb_size / packet) > ACCESIO_USB_ISO_PACKETS_MAX) { return -EINVAL; }
+    if (config->ring_size == 0) { config->ring_size = roundup_pow_of_two(config->urb_count * config->urb_size * 4); }
+    if (!is_power_of_2(config->ring_size) || config->ring_size > ACCESIO_USB_STREAM_RING_MAX ||
+        config->ring_size < (config->urb_count * config->urb_size * 2))
+    {
+        return -EINVAL;
+    }
+    if (config->low_water == 0) { config->low_water = config->ring_size / 2; }
+    if (config->low_water >= config->ring_size) { return -EINVAL; }
+    mutex_lock(&stream->io_lock);
+    vfree(stream->control);
+    // zeroed and page aligned, as it may be mapped
+    stream->control = vmalloc_user(PAGE_SIZE + PAGE_ALIGN(config->ring_size));
+    stream->ring = (stream->control ? (uint8_t*)stream->control + PAGE_SIZE : NULL);
+    stream->ring_size = (stream->control ? config->ring_size : 0);
+    stream->head = 0;
+    if (stream->control) {
+        stream->control->ring_size = config->ring_size;
+        stream->control->data_offset = PAGE_SIZE;
+    }
+    mutex_unlock(&stream->io_lock);
+    if (!stream->control) { return -ENOMEM; }
+    stream->urb_count = config->urb_count;
+    stream->urb_size = config->urb_size;
+    stream->low_water = config->low_water;
+    for (i = 0; i < stream->urb_count; ++i) {
+        stream->urbs[i] = usb_alloc_urb((iso ? (config->urb_size / packet) : 0), GFP_KERNEL);
+        if (!stream->urbs[i]) { return -ENOMEM; }
+        buffer = usb_alloc_coherent(dev->udev, stream->urb_size, GFP_KERNEL, &stream->urbs[i]->transfer_dma);
+        if (!buffer) { return -ENOMEM; }
+        stream->urbs[i]->transfer_buffer = buffer;
+        stream->urbs[i]->transfer_flags |= URB_NO_TRANSFER_DMA_MAP;
+    }
+    spin_lock_irq(&stream->urb_lock);
+    stream->error = 0;
+    stream->bytes = 0;
+    stream->overruns = 0;
+    stream->underruns = 0;
+    stream->errors = 0;
+    stream->urbs_done = 0;
+    stream->stamps_dropped = 0;
+    memset(&stream->clock, 0, sizeof(accesio_usb_clock));
+    if (kfifo_initialized(&stream->stamps)) { kfifo_reset(&stream->stamps); }
+    spin_unlock_irq(&stream->urb_lock);
+    return ACCESIO_SUCCESS;
+}
+
+// submits the input URB set or parks the output one, stream->lock held
+static int accesio_usb_stream_submit(accesio_usb_device_info* dev, accesio_usb_stream* stream, bool in)
+{
+    uint32_t i = 0;
+    int rc = ACCESIO_SUCCESS;
+    // this lock makes sure we don't submit URBs to gone devices
+    down_read(&dev->io_rwsem);
+    if (!dev->interface) {
+        up_read(&dev->io_rwsem);
+        return -ENODEV;
+    }
+    spin_lock_irq(&stream->urb_lock);
+    stream->running = true;
+    for (i = 0; !in && i < stream->urb_count; ++i) {
+        stream->idle[i] = stream->urbs[i];
+    }
+    stream->idle_count = (in ? 0 : stream->urb_count);
+    spin_unlock_irq(&stream->urb_lock);
+    for (i = 0; in && rc == ACCESIO_SUCCESS && i < stream->urb_count; ++i) {
+        usb_anchor_urb(stream->urbs[i], &stream->anchor);
+        rc = usb_submit_urb(stream->urbs[i], GFP_KERNEL);
+        if (rc < 0) {
+            printk(KERN_INFO KBUILD_MODNAME ": error submitting stream urb %d.\n", rc);
+            usb_unanchor_urb(stream->urbs[i]);
+        }
+    }
+    up_read(&dev->io_rwsem);
+    return rc;
+}
+
+static ssize_t accesio_usb_stream_read(accesio_usb_stream* stream, struct file* filp, char* buffer, size_t count)
+{
+    ssize_t rv = 0;
+    uint32_t tail, available, chunk;
+    rv = mutex_lock_interruptible(&stream->io_lock);
+    if (rv < 0) { return rv; }
+    // released since read() looked
+    if (!stream->control) { goto exit; }
+    for (;;) {
+        tail = stream->control->tail;
+        available = accesio_usb_stream_used(stream);
+        if (available) { break; }
+        // drained, a stream that stopped on an error reports it once
+        if (!READ_ONCE(stream->running)) {
+            spin_lock_irq(&stream->urb_lock);
+            rv = stream->error;
+            stream->error = 0;
+            spin_unlock_irq(&stream->urb_lock);
+            if (rv < 0 && rv != -EPIPE) { rv = -EIO; }
+            goto exit;
+        }
+        if (filp->f_flags & O_NONBLOCK) {
+            rv = -EAGAIN;
+            goto exit;
+        }
+        rv = wait_event_interruptible(stream->wait, (accesio_usb_stream_used(stream) != 0 || !READ_ONCE(stream->running)));
+        if (rv < 0) { goto exit; }
+    }
+    chunk = min_t(size_t, available, count);
+    if (accesio_usb_stream_copy_out(stream, tail, buffer, chunk)) {
+        rv = -EFAULT;
+        goto exit;
+    }
+    smp_store_release(&stream->control->tail, tail + chunk);
+    rv = chunk;
+    exit:
+        mutex_unlock(&stream->io_lock);
+        return rv;
+}
+
+static ssize_t accesio_usb_stream_write(accesio_usb_stream* stream, struct file* filp, const char* buffer, size_t count)
+{
+    ssize_t rv = 0;
+    uint32_t head, space, chunk, first;
+    rv = mutex_lock_interruptible(&stream->io_lock);
+    if (rv < 0) { return rv; }
+    for (;;) {
+        // a stream that stopped reports its error once
+        if (!READ_ONCE(stream->running)) {
+            spin_lock_irq(&stream->urb_lock);
+            rv = stream->error;
+            stream->error = 0;
+            spin_unlock_irq(&stream->urb_lock);
+            rv = (rv == -EPIPE ? -EPIPE : -EIO);
+            goto exit;
+        }
+        head = stream->head;
+        space = stream->ring_size - accesio_usb_stream_used(stream);
+        if (space) { break; }
+        if (filp->f_flags & O_NONBLOCK) {
+            rv = -EAGAIN;
+            goto exit;
+        }
+        // the completions wake us once the ring drained to the low-water mark
+        rv = wait_event_interruptible(stream->wait, (accesio_usb_stream_used(stream) <= stream->low_water || !READ_ONCE(stream->running)));
+        if (rv < 0) { goto exit; }
+    }
+    chunk = min_t(size_t, space, count);
+    first = min(chunk, stream->ring_size - (head & (stream->ring_size - 1)));
+    if (copy_from_user(stream->ring + (head & (stream->ring_size - 1)), buffer, first) ||
+        copy_from_user(stream->ring, buffer + first, chunk - first))
+    {
+        rv = -EFAULT;
+        goto exit;
+    }
+    accesio_usb_stream_publish(stream, head + chunk);
+    accesio_usb_stream_out_kick(stream);
+    rv = chunk;
+    exit:
+        mutex_unlock(&stream->io_lock);
+        return rv;
+}
+
+/*
+ * The interrupt-IN listener keeps the endpoint's URB armed and queues every
+ * report with the time it arrived, pollers get POLLPRI while reports wait.
+ */
+
+static void accesio_usb_interrupt_callback(struct urb* purb)
+{
+    int rc = 0;
+    unsigned long flags;
+    accesio_usb_device_info* dev = purb->context;
+    accesio_usb_interrupt* interrupt = &dev->interrupt;
+    accesio_usb_interrupt_report report;
+    memset(&report, 0, sizeof(accesio_usb_interrupt_report));
+    report.timestamp_ns = ktime_get_ns();
+    spin_lock_irqsave(&interrupt->queue_lock, flags);
+    if (purb->status == 0) {
+        report.sequence = interrupt->sequence++;
+        report.length = min_t(uint32_t, purb->actual_length, ACCESIO_USB_INTERRUPT_REPORT_MAX);
+        memcpy(report.data, purb->transfer_buffer, report.length);
+        if (!kfifo_put(&interrupt->reports, report)) { ++interrupt->dropped; }
+    } else if (!accesio_usb_stream_killed(purb->status)) {
+        printk(KERN_INFO KBUILD_MODNAME ": non-zero interrupt status received %d.\n", purb->status);
+    }
+    if (interrupt->running) {
+        rc = (accesio_usb_stream_fatal(purb->status) ? purb->status : usb_submit_urb(purb, GFP_ATOMIC));
+        if (rc < 0) {
+            interrupt->error = rc;
+            interrupt->running = false;
+        }
+    }
+    spin_unlock_irqrestore(&interrupt->queue_lock, flags);
+    wake_up_interruptible(&interrupt->wait);
+}
+
+static void accesio_usb_interrupt_stop(accesio_usb_device_info* dev)
+{
+    spin_lock_irq(&dev->interrupt.queue_lock);
+    dev->interrupt.running = false;
+    spin_unlock_irq(&dev->interrupt.queue_lock);
+    if (dev->endpoints.interrupt.in.urb) { usb_kill_urb(dev->endpoints.interrupt.in.urb); }
+}
+
+/*
+ * write() takes its URB and coherent buffer from a pool allocated up front.
+ * limit_sem counts the free entries, a write that got past it always finds
+ * one, so writes allocate nothing once the device is probed.
+ */
+
+static void accesio_usb_write_pool_free(accesio_usb_device_info* dev, accesio_usb_write_pool* pool)
+{
+    uint32_t i = 0;
+    struct urb* purb = NULL;
+    for (i = 0; pool->entries && i < pool->depth; ++i) {
+        purb = pool->entries[i].urb;
+        if (purb == NULL) { continue; }
+        if (purb->transfer_buffer) {
+            usb_free_coherent(dev->udev, ACCESIO_USB_MAX_XFR, purb->transfer_buffer, purb->transfer_dma);
+        }
+        usb_free_urb(purb);
+    }
+    kfree(pool->entries);
+    kfree(pool->free);
+    pool->entries = NULL;
+    pool->free = NULL;
+    pool->depth = 0;
+    pool->free_count = 0;
+}
+
+// fills in the entries of an unused pool, it is freed on failure
+static int accesio_usb_write_pool_alloc(accesio_usb_device_info* dev, accesio_usb_write_pool* pool, uint32_t depth)
+{
+    uint32_t i = 0;
+    void* buffer = NULL;
+    struct urb* purb = NULL;
+    pool->entries = kcalloc(depth, sizeof(accesio_usb_write_urb), GFP_KERNEL);
+    pool->free = kcalloc(depth, sizeof(accesio_usb_write_urb*), GFP_KERNEL);
+    pool->depth = depth;
+    if (!pool->entries || !pool->free) { goto error; }
+    for (i = 0; i < depth; ++i) {
+        purb = usb_alloc_urb(0, GFP_KERNEL);
+        if (!purb) { goto error; }
+        pool->entries[i].urb = purb;
+        pool->entries[i].dev = dev;
+        buffer = usb_alloc_coherent(dev->udev, ACCESIO_USB_MAX_XFR, GFP_KERNEL, &purb->transfer_dma);
+        if (!buffer) { goto error; }
+        purb->transfer_buffer = buffer;
+        purb->transfer_flags |= URB_NO_TRANSFER_DMA_MAP;
+        pool->free[i] = &pool->entries[i];
+    }
+    pool->free_count = depth;
+    return ACCESIO_SUCCESS;
+    error:
+        accesio_usb_write_pool_free(dev, pool);
+        return -ENOMEM;
+}
+
+static accesio_usb_write_urb* accesio_usb_write_pool_get(accesio_usb_write_pool* pool)
+{
+    accesio_usb_write_urb* entry = NULL;
+    spin_lock_irq(&pool->lock);
+    entry = pool->free[--pool->free_count];
+    spin_unlock_irq(&pool->lock);
+    return entry;
+}
+
+static void accesio_usb_write_pool_put(accesio_usb_write_pool* pool, accesio_usb_write_urb* entry)
+{
+    unsigned long flags;
+    spin_lock_irqsave(&pool->lock, flags);
+    pool->free[pool->free_count++] = entry;
+    spin_unlock_irqrestore(&pool->lock, flags);
+}
+
+static char* accesio_usb_get_devnode(struct device* dev, umode_t* mode)
+{
+    return kasprintf(GFP_KERNEL,
+                     DRIVER_CLASS_NAME"/%s_%u",
+                     dev_name(dev), MINOR(dev->devt));
+}
+
+static void accesio_usb_delete(struct kref* kobj)
+{
+    accesio_usb_device_info* dev = container_of(kobj, accesio_usb_device_info, kref);
+    decrement_device_id(dev->product_id);
+    --accesio_found_devices;
+    accesio_usb_print_dev(dev, "unregistering device ", false);
+    if (dev->interface != NULL) {
+        usb_set_intfdata(dev->interface, NULL);
+        // give back our minor
+        usb_deregister_dev(dev->interface, &accesio_usb_class);
+        // prevent more I/O from starting, waits out the transfers under way
+        down_write(&dev->io_rwsem);
+        dev->interface = NULL;
+        up_write(&dev->io_rwsem);
+        usb_kill_anchored_urbs(&dev->submitted);
+        usb_kill_anchored_urbs(&dev->async_anchor);
+    }
+    accesio_usb_stream_release(dev, &dev->stream_in, NULL);
+    accesio_usb_stream_release(dev, &dev->stream_out, NULL);
+    accesio_usb_stream_release(dev, &dev->stream_iso, NULL);
+    accesio_usb_interrupt_stop(dev);
+    kfifo_free(&dev->interrupt.reports);
+    kfifo_free(&dev->stream_in.stamps);
+    accesio_usb_async_free_done(dev, NULL);
+    // a merged URB left by a failed push on disconnect is freed with the pool
+    hrtimer_cancel(&dev->coalesce.timer);
+    cancel_work_sync(&dev->coalesce.work);
+    dev->coalesce.entry = NULL;
+    accesio_usb_write_pool_free(dev, &dev->write_pool);
+    mutex_destroy(&dev->endpoints.bulk.in.lock);
+    mutex_destroy(&dev->endpoints.bulk.out.lock);
+    mutex_destroy(&dev->endpoints.control.in.lock);
+    mutex_destroy(&dev->endpoints.control.out.lock);
+    accesio_usb_free_endpoint_info(&dev->endpoints.bulk);
+    accesio_usb_free_endpoint_info(&dev->endpoints.control);
+    accesio_usb_free_endpoint_info(&dev->endpoints.isochronous);
+    accesio_usb_free_endpoint_info(&dev->endpoints.interrupt);
+    usb_put_dev(dev->udev);
+    kfree(dev);
+}
+
+static int accesio_usb_open(struct inode* inode, struct file* filp)
+{
+    accesio_usb_device_info* dev;
+    int tmp = iminor(inode);
+    struct usb_interface* interface = usb_find_interface(&accesio_usb_driver, tmp);
+    if (!interface) {
+        printk(KERN_INFO KBUILD_MODNAME ": error finding device for minor %d.\n", tmp);
+        return -ENODEV;
+    }
+    dev = usb_get_intfdata(interface);
+    if (!dev) {
+        printk(KERN_INFO KBUILD_MODNAME ": error retrieving interface data.\n");
+        return -ENODEV;
+    }
+    #if defined(CONFIG_PM) || defined(ACCESIO_USB_AUTOSUSPEND)
+        tmp = usb_autopm_get_interface(interface);
+        if (tmp != 0) {
+            printk(KERN_INFO KBUILD_MODNAME ": error retrieving PM interface data %d.\n", tmp);
+            return tmp;
+        }
+    #endif
+    // increment our usage count for the device
+    kref_get(&dev->kref);
+    // save our object in the file's private structure
+    filp->private_data = dev;
+    return ACCESIO_SUCCESS;
+}
+
+static int accesio_usb_release(struct inode* inode, struct file* filp)
+{
+    accesio_usb_device_info* dev = filp->private_data;
+    if (dev == NULL) { return -ENODEV; }
+    // streams don't outlive the file that started them
+    accesio_usb_stream_release(dev, &dev->stream_in, filp);
+    accesio_usb_stream_release(dev, &dev->stream_out, filp);
+    accesio_usb_stream_release(dev, &dev->stream_iso, filp);
+    mutex_lock(&dev->interrupt.lock);
+    if (dev->interrupt.owner == filp) {
+        accesio_usb_interrupt_stop(dev);
+        dev->interrupt.owner = NULL;
+    }
+    mutex_unlock(&dev->interrupt.lock);
+    #if defined(CONFIG_PM) || defined(ACCESIO_USB_AUTOSUSPEND)
+        // allow the device to be autosuspended
+        down_read(&dev->io_rwsem);
+        if (dev->interface) {
+            usb_autopm_put_interface(dev->interface);
+        }
+        up_read(&dev->io_rwsem);
+    #endif
+    // decrement the count on our device
+    kref_put(&dev->kref, accesio_usb_delete);
+    return ACCESIO_SUCCESS;
+}
+
+static int accesio_usb_flush(struct file* filp, fl_owner_t id)
+{
+    int res = 0;
+    accesio_usb_device_info* dev = filp->private_data;
+    if (dev == NULL) { return -ENODEV; }
+    // merged writes go out before the draw down waits for them
+    mutex_lock(&dev->coalesce.lock);
+    accesio_usb_coalesce_push(dev);
+    mutex_unlock(&dev->coalesce.lock);
+    // only this file's asynchronous transfers, other opens still reap theirs
+    accesio_usb_async_kill(dev, filp);
+    accesio_usb_async_free_done(dev, filp);
+    // wait for io to stop
+    down_write(&dev->io_rwsem);
+    accesio_usb_draw_down(dev);
+    // read out errors, leave subsequent opens in a clean slate
+    spin_lock_irq(&dev->err_lock);
+    if (dev->errors) {
+        res = (dev->errors == -EPIPE ? -EPIPE : -EIO);
+    }
+    dev->errors = 0;
+    spin_unlock_irq(&dev->err_lock);
+    up_write(&dev->io_rwsem);
+    return res;
+}
+
+static void accesio_usb_read_bulk_callback(struct urb* purb)
+{
+    unsigned long flags;
+    accesio_usb_device_info* dev = purb->context;
+    spin_lock_irqsave(&dev->err_lock, flags);
+    if (purb->status) {
+        // sync/async unlink faults aren't errors
+        if (!(purb->status == -ENOENT || purb->status == -ECONNRESET || purb->status == -ESHUTDOWN)) {
+            printk(KERN_INFO KBUILD_MODNAME ": non-zero write bulk status received %d.\n", purb->status);
+        }
+        dev->errors = purb->status;
+    } else {
+        dev->endpoints.bulk.in.filled = purb->actual_length;
+    }
+    dev->endpoints.bulk.in.completed_ns = ktime_get_ns();
+    dev->ongoing_read = 0;
+    spin_unlock_irqrestore(&dev->err_lock, flags);
+    wake_up_interruptible(&dev->io_wait);
+}
+
+/* Submits the read URB, bulk.in's lock held. io_rwsem is only held for the
+ * submission, so a reader waiting on the device doesn't hold up a flush or
+ * reset and with it every other transfer. */
+static int accesio_usb_do_read_io(accesio_usb_device_info* dev, size_t count)
+{
+    int rv = 0;
+    down_read(&dev->io_rwsem);
+    // disconnect() was called
+    if (!dev->interface) {
+        up_read(&dev->io_rwsem);
+        return -ENODEV;
+    }
+    // prepare a read
+    usb_fill_bulk_urb(dev->endpoints.bulk.in.urb,
+                      dev->udev,
+                      usb_rcvbulkpipe(dev->udev, dev->endpoints.bulk.in.address),
+                      dev->endpoints.bulk.in.buffer,
+                      min(dev->endpoints.bulk.in.buffer_size, count),
+                      accesio_usb_read_bulk_callback,
+                      dev);
+
+
+    // tell everybody to leave the URB alone
+    spin_lock_irq(&dev->err_lock);
+    dev->ongoing_read = 1;
+    spin_unlock_irq(&dev->err_lock);
+    // submit bulk in urb, which means no data to deliver
+    dev->endpoints.bulk.in.filled = 0;
+    dev->endpoints.bulk.in.copied = 0;
+    // do it
+    rv = usb_submit_urb(dev->endpoints.bulk.in.urb, GFP_KERNEL);
+    if (rv < 0) {
+        // dev_err(&dev->interface->dev, "%s - failed submitting read urb, error %d\n", __func__, rv);
+        printk(KERN_INFO KBUILD_MODNAME ": error submitting read urb, %d.\n", rv);
+        if (rv != -ENOMEM) { rv = -EIO; }
+        spin_lock_irq(&dev->err_lock);
         dev->ongoing_read = 0;
         spin_unlock_irq(&dev->err_lock);
     }
+    up_read(&dev->io_rwsem);
     return rv;
 }
 
@@ -793,14 +1586,13 @@ static ssize_t accesio_usb_read(struct file* filp, char* buffer, size_t count, l
     accesio_usb_device_info* dev = filp->private_data;
     // if we cannot read at all, return EOF
     if (!dev->endpoints.bulk.in.urb || !count) { return 0; }
-    // no concurrent readers
-    rv = mutex_lock_interruptible(&dev->io_mutex);
-    if (rv < 0) { return rv; }
-    // disconnect() was called
-    if (!dev->interface) {
-        mutex_unlock(&dev->io_mutex);
-        return -ENODEV;
+    // a running stream owns the endpoint, once stopped what it left is read first
+    if (READ_ONCE(dev->stream_in.running) || accesio_usb_stream_fill(&dev->stream_in) != 0) {
+        return accesio_usb_stream_read(&dev->stream_in, filp, buffer, count);
     }
+    // no concurrent readers, io_rwsem is only taken to submit
+    rv = mutex_lock_interruptible(&dev->endpoints.bulk.in.lock);
+    if (rv < 0) { return rv; }
 
     // if IO is under way, we must not touch things
     for (;;) { //retry:
@@ -863,120 +1655,365 @@ static ssize_t accesio_usb_read(struct file* filp, char* buffer, size_t count, l
             }
         }
     } // exit:
-    mutex_unlock(&dev->io_mutex);
+    mutex_unlock(&dev->endpoints.bulk.in.lock);
     return rv;
 }
 
 static void accesio_usb_write_bulk_callback(struct urb* purb)
 {
-    unsigned long flags;
-    accesio_usb_device_info* dev = purb->context;
-    // sync/async unlink faults aren't errors
-    if (purb->status) {
-        if (!(purb->status == -ENOENT || purb->status == -ECONNRESET || purb->status == -ESHUTDOWN)) {
-            printk(KERN_INFO KBUILD_MODNAME ": non-zero write bulk status received %d.\n", purb->status);
-        }
-        spin_lock_irqsave(&dev->err_lock, flags);
-        dev->errors = purb->status;
-        spin_unlock_irqrestore(&dev->err_lock, flags);
-    }
-    // free up our allocated buffer
-    usb_free_coherent(purb->dev,
-                      purb->transfer_buffer_length,
-                      purb->transfer_buffer,
-                      purb->transfer_dma);
-    up(&dev->limit_sem);
+    unsigned long flags;
+    accesio_usb_write_urb* entry = purb->context;
+    accesio_usb_device_info* dev = entry->dev;
+    // sync/async unlink faults aren't errors
+    if (purb->status) {
+        if (!(purb->status == -ENOENT || purb->status == -ECONNRESET || purb->status == -ESHUTDOWN)) {
+            printk(KERN_INFO KBUILD_MODNAME ": non-zero write bulk status received %d.\n", purb->status);
+        }
+        spin_lock_irqsave(&dev->err_lock, flags);
+        dev->errors = purb->status;
+        spin_unlock_irqrestore(&dev->err_lock, flags);
+    }
+    // give the URB and its buffer back to the pool
+    accesio_usb_write_pool_put(&dev->write_pool, entry);
+    up(&dev->limit_sem);
+    // pollers waiting for room to write
+    wake_up_interruptible(&dev->io_wait);
+}
+
+/* Takes a limit_sem count, which guarantees a free pool entry, and reports a
+ * pending error once, in which case the count is given back. */
+static int accesio_usb_write_reserve(accesio_usb_device_info* dev, struct file* filp)
+{
+    int retval = 0;
+    // limit the number of URBs in flight to the pool, every URB of it is in flight when this fails
+    if (down_trylock(&dev->limit_sem)) {
+        spin_lock_irq(&dev->write_pool.lock);
+        ++dev->write_pool.exhausted;
+        spin_unlock_irq(&dev->write_pool.lock);
+        if (filp && (filp->f_flags & O_NONBLOCK)) { return -EAGAIN; }
+        if (down_interruptible(&dev->limit_sem)) { return -ERESTARTSYS; }
+    }
+    spin_lock_irq(&dev->err_lock);
+    retval = dev->errors;
+    if (retval < 0) {
+        // any error is reported once
+        dev->errors = 0;
+        // to preserve notifications about reset
+        if (retval != -EPIPE) { retval = -EIO; }
+    }
+    spin_unlock_irq(&dev->err_lock);
+    if (retval < 0) {
+        up(&dev->limit_sem);
+        return retval;
+    }
+    return ACCESIO_SUCCESS;
+}
+
+// sends a reserved entry, the caller gives it back on failure
+static int accesio_usb_write_submit(accesio_usb_device_info* dev, accesio_usb_write_urb* entry, size_t writesize)
+{
+    int retval = 0;
+    // this lock makes sure we don't submit URBs to gone devices
+    down_read(&dev->io_rwsem);
+    if (!dev->interface) {
+        // disconnect() was called
+        up_read(&dev->io_rwsem);
+        return -ENODEV;
+    }
+    // initialize the urb properly
+    usb_fill_bulk_urb(entry->urb,
+                      dev->udev,
+                      usb_sndbulkpipe(dev->udev, dev->endpoints.bulk.out.address),
+                      entry->urb->transfer_buffer,
+                      writesize,
+                      accesio_usb_write_bulk_callback,
+                      entry);
+    usb_anchor_urb(entry->urb, &dev->submitted);
+    // send the data out the bulk port
+    retval = usb_submit_urb(entry->urb, GFP_KERNEL);
+    up_read(&dev->io_rwsem);
+
+    if (retval) {
+        printk(KERN_INFO KBUILD_MODNAME ": error submitting write urb %d.\n", retval);
+        usb_unanchor_urb(entry->urb);
+        return retval;
+    }
+    spin_lock_irq(&dev->write_pool.lock);
+    ++dev->write_pool.writes;
+    spin_unlock_irq(&dev->write_pool.lock);
+    return ACCESIO_SUCCESS;
+}
+
+/* Sends the URB being merged into, coalesce.lock held. A failure is reported
+ * by the next write() like that of a completed URB. */
+static void accesio_usb_coalesce_push(accesio_usb_device_info* dev)
+{
+    int rc = 0;
+    accesio_usb_coalesce* coalesce = &dev->coalesce;
+    if (!coalesce->entry) { return; }
+    hrtimer_cancel(&coalesce->timer);
+    rc = accesio_usb_write_submit(dev, coalesce->entry, coalesce->length);
+    if (rc < 0) {
+        spin_lock_irq(&dev->err_lock);
+        dev->errors = rc;
+        spin_unlock_irq(&dev->err_lock);
+        accesio_usb_write_pool_put(&dev->write_pool, coalesce->entry);
+        up(&dev->limit_sem);
+    }
+    coalesce->entry = NULL;
+    coalesce->length = 0;
+}
+
+static enum hrtimer_restart accesio_usb_coalesce_timeout(struct hrtimer* timer)
+{
+    accesio_usb_device_info* dev = container_of(timer, accesio_usb_device_info, coalesce.timer);
+    schedule_work(&dev->coalesce.work);
+    return HRTIMER_NORESTART;
+}
+
+static void accesio_usb_coalesce_work(struct work_struct* work)
+{
+    accesio_usb_device_info* dev = container_of(work, accesio_usb_device_info, coalesce.work);
+    mutex_lock(&dev->coalesce.lock);
+    accesio_usb_coalesce_push(dev);
+    mutex_unlock(&dev->coalesce.lock);
+}
+
+/* Appends a small write to the URB being filled, starting one and its timer
+ * when there is none, and sends it once the next write wouldn't fit. */
+static ssize_t accesio_usb_write_coalesced(accesio_usb_device_info* dev, struct file* filp, const char* user_buffer, size_t count)
+{
+    ssize_t retval = 0;
+    accesio_usb_coalesce* coalesce = &dev->coalesce;
+    retval = mutex_lock_interruptible(&coalesce->lock);
+    if (retval < 0) { return retval; }
+    if (coalesce->entry && (coalesce->length + count) > coalesce->size) { accesio_usb_coalesce_push(dev); }
+    if (!coalesce->entry) {
+        retval = accesio_usb_write_reserve(dev, filp);
+        if (retval < 0) { goto exit; }
+        coalesce->entry = accesio_usb_write_pool_get(&dev->write_pool);
+        coalesce->length = 0;
+        hrtimer_start(&coalesce->timer, ns_to_ktime((u64)coalesce->delay_us * 1000), HRTIMER_MODE_REL);
+    }
+    if (copy_from_user((uint8_t*)coalesce->entry->urb->transfer_buffer + coalesce->length, user_buffer, count)) {
+        retval = -EFAULT;
+        // nothing merged yet, the entry goes back
+        if (coalesce->length == 0) {
+            hrtimer_cancel(&coalesce->timer);
+            accesio_usb_write_pool_put(&dev->write_pool, coalesce->entry);
+            up(&dev->limit_sem);
+            coalesce->entry = NULL;
+        }
+        goto exit;
+    }
+    coalesce->length += count;
+    if (coalesce->length >= coalesce->size) { accesio_usb_coalesce_push(dev); }
+    retval = count;
+    exit:
+        mutex_unlock(&coalesce->lock);
+        return retval;
+}
+
+/* Sends what is being merged and waits for every write() URB to complete,
+ * then reports an error any of them had. */
+static int accesio_usb_write_sync(accesio_usb_device_info* dev)
+{
+    int rc = mutex_lock_interruptible(&dev->coalesce.lock);
+    if (rc < 0) { return rc; }
+    accesio_usb_coalesce_push(dev);
+    mutex_unlock(&dev->coalesce.lock);
+    rc = wait_event_interruptible(dev->io_wait, (READ_ONCE(dev->write_pool.free_count) == READ_ONCE(dev->write_pool.depth) || !dev->interface));
+    if (rc < 0) { return rc; }
+    if (!dev->interface) { return -ENODEV; }
+    spin_lock_irq(&dev->err_lock);
+    rc = dev->errors;
+    dev->errors = 0;
+    spin_unlock_irq(&dev->err_lock);
+    if (rc < 0 && rc != -EPIPE) { rc = -EIO; }
+    return rc;
+}
+
+#if LINUX_VERSION_CODE < KERNEL_VERSION(3,1,0)
+static int accesio_usb_fsync(struct file* filp, int datasync)
+#else
+static int accesio_usb_fsync(struct file* filp, loff_t start, loff_t end, int datasync)
+#endif
+{
+    accesio_usb_device_info* dev = filp->private_data;
+    if (dev == NULL) { return -ENODEV; }
+    return accesio_usb_write_sync(dev);
 }
 
 static ssize_t accesio_usb_write(struct file* filp, const char* user_buffer, size_t count, loff_t* ppos)
 {
     int retval = 0;
-    struct urb* urb = NULL;
-    char* buf = NULL;
+    accesio_usb_write_urb* entry = NULL;
     size_t writesize = min(count, (size_t)ACCESIO_USB_MAX_XFR);
     accesio_usb_device_info* dev = filp->private_data;
     // verify that we actually have some data to write
     if (count == 0) {
         goto exit;
     }
-    // limit the number of URBs in flight to stop a user from using up all RAM
-    if (!(filp->f_flags & O_NONBLOCK)) {
-        if (down_interruptible(&dev->limit_sem)) {
-            retval = -ERESTARTSYS;
-            goto exit;
-        }
-    } else {
-        if (down_trylock(&dev->limit_sem)) {
-            retval = -EAGAIN;
-            goto exit;
+    // a running stream owns the endpoint
+    if (READ_ONCE(dev->stream_out.running)) {
+        return accesio_usb_stream_write(&dev->stream_out, filp, user_buffer, count);
+    }
+    if (READ_ONCE(dev->coalesce.size) != 0) {
+        if (count < READ_ONCE(dev->coalesce.size)) {
+            return accesio_usb_write_coalesced(dev, filp, user_buffer, count);
         }
+        // what was merged goes out first
+        retval = mutex_lock_interruptible(&dev->coalesce.lock);
+        if (retval < 0) { goto exit; }
+        accesio_usb_coalesce_push(dev);
+        mutex_unlock(&dev->coalesce.lock);
     }
-    spin_lock_irq(&dev->err_lock);
-    retval = dev->errors;
+    retval = accesio_usb_write_reserve(dev, filp);
     if (retval < 0) {
-        // any error is reported once
-        dev->errors = 0;
-        // to preserve notifications about reset
-        if (retval != -EPIPE) { retval = -EIO; }
+        goto exit;
     }
-    spin_unlock_irq(&dev->err_lock);
-    if (retval < 0) {
+    // take a urb and its buffer from the pool, and copy the data to the urb
+    entry = accesio_usb_write_pool_get(&dev->write_pool);
+    if (copy_from_user(entry->urb->transfer_buffer, user_buffer, writesize)) {
+        retval = -EFAULT;
         goto error;
     }
-    // create a urb, and a buffer for it, and copy the data to the urb
-    urb = usb_alloc_urb(0, GFP_KERNEL);
-    if (!urb) {
-        retval = -ENOMEM;
+    retval = accesio_usb_write_submit(dev, entry, writesize);
+    if (retval < 0) {
         goto error;
     }
-    buf = usb_alloc_coherent(dev->udev, writesize, GFP_KERNEL, &urb->transfer_dma);
-    if (!buf) {
-        retval = -ENOMEM;
-        goto error;
+    return writesize;
+    error:
+        accesio_usb_write_pool_put(&dev->write_pool, entry);
+        up(&dev->limit_sem);
+    exit:
+        return retval;
+}
+
+static inline int accesio_usb_ioctl_internal_async_submit(accesio_usb_device_info* ddata, struct file* filp, unsigned long arg)
+{
+    int rc = 0;
+    void* buffer = NULL;
+    bool in = false;
+    unsigned int pipe = 0;
+    accesio_usb_async* async = NULL;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_usb_async_request)) == 0) { return -EACCES; }
+    async = kzalloc(sizeof(accesio_usb_async), GFP_KERNEL);
+    if (!async) { return -ENOMEM; }
+    if (copy_from_user(&async->request, (accesio_usb_async_request*)arg, sizeof(accesio_usb_async_request)) != 0) { rc = -EIO; goto error; }
+    in = (async->request.direction == ACCESIO_USB_DIR_IN);
+    if (async->request.direction != ACCESIO_USB_DIR_IN && async->request.direction != ACCESIO_USB_DIR_OUT) { rc = -EINVAL; goto error; }
+    if (async->request.msg_type != ACCESIO_USB_IOCTL_BULK_MSG && async->request.msg_type != ACCESIO_USB_IOCTL_CTRL_MSG) { rc = -EINVAL; goto error; }
+    if (async->request.length > ACCESIO_USB_ASYNC_LENGTH_MAX || (async->request.length != 0 && async->request.data == NULL)) { rc = -EINVAL; goto error; }
+    if (async->request.msg_type == ACCESIO_USB_IOCTL_CTRL_MSG && async->request.length > 0xFFFF) { rc = -EINVAL; goto error; }
+    if (async->request.msg_type == ACCESIO_USB_IOCTL_BULK_MSG && accesio_usb_stream_busy(ddata, in)) { rc = -EBUSY; goto error; }
+    // the buffer is handed to the host controller, it can't be the user's memory
+    buffer = kmalloc(max_t(uint32_t, async->request.length, 1), GFP_KERNEL);
+    async->urb = usb_alloc_urb(0, GFP_KERNEL);
+    if (!buffer || !async->urb) { rc = -ENOMEM; goto error; }
+    if (!in && async->request.length != 0 && copy_from_user(buffer, async->request.data, async->request.length) != 0) { rc = -EFAULT; goto error; }
+    async->dev = ddata;
+    async->owner = filp;
+    async->request.status = 0;
+    async->request.actual_length = 0;
+    if (async->request.msg_type == ACCESIO_USB_IOCTL_BULK_MSG) {
+        pipe = (in ? usb_rcvbulkpipe(ddata->udev, ddata->endpoints.bulk.in.address) : usb_sndbulkpipe(ddata->udev, ddata->endpoints.bulk.out.address));
+        usb_fill_bulk_urb(async->urb, ddata->udev, pipe, buffer, async->request.length, accesio_usb_async_callback, async);
+    } else {
+        pipe = (in ? usb_rcvctrlpipe(ddata->udev, ddata->endpoints.control.in.address) : usb_sndctrlpipe(ddata->udev, ddata->endpoints.control.out.address));
+        async->setup.bRequestType = ((in ? USB_DIR_IN : USB_DIR_OUT) | USB_TYPE_VENDOR | USB_RECIP_DEVICE);
+        async->setup.bRequest = async->request.request;
+        async->setup.wValue = cpu_to_le16(async->request.value);
+        async->setup.wIndex = cpu_to_le16(async->request.index);
+        async->setup.wLength = cpu_to_le16(async->request.length);
+        usb_fill_control_urb(async->urb, ddata->udev, pipe, (unsigned char*)&async->setup, buffer, async->request.length, accesio_usb_async_callback, async);
     }
-    if (copy_from_user(buf, user_buffer, writesize)) {
-        retval = -EFAULT;
+    spin_lock_irq(&ddata->async_lock);
+    if (ddata->async_count >= ACCESIO_USB_ASYNC_MAX) {
+        spin_unlock_irq(&ddata->async_lock);
+        rc = -EAGAIN;
         goto error;
     }
-
+    ++ddata->async_count;
+    async->request.tag = ++ddata->async_tag;
+    list_add_tail(&async->list, &ddata->async_pending);
+    spin_unlock_irq(&ddata->async_lock);
+    if (copy_to_user(&((accesio_usb_async_request*)arg)->tag, &async->request.tag, sizeof(uint64_t)) != 0) { rc = -EIO; goto unlist; }
     // this lock makes sure we don't submit URBs to gone devices
-    mutex_lock(&dev->io_mutex);
-    if (!dev->interface) {
-        // disconnect() was called
-        mutex_unlock(&dev->io_mutex);
-        retval = -ENODEV;
-        goto error;
+    down_read(&ddata->io_rwsem);
+    if (!ddata->interface) {
+        up_read(&ddata->io_rwsem);
+        rc = -ENODEV;
+        goto unlist;
     }
-    // initialize the urb properly
-    usb_fill_bulk_urb(urb,
-                      dev->udev,
-                      usb_sndbulkpipe(dev->udev, dev->endpoints.bulk.out.address),
-                      buf,
-                      writesize,
-                      accesio_usb_write_bulk_callback,
-                      dev);
-    urb->transfer_flags |= URB_NO_TRANSFER_DMA_MAP;
-    usb_anchor_urb(urb, &dev->submitted);
-    // send the data out the bulk port
-    retval = usb_submit_urb(urb, GFP_KERNEL);
-    mutex_unlock(&dev->io_mutex);
-
-    if (retval) {
-        printk(KERN_INFO KBUILD_MODNAME ": error submitting write urb %d.\n", retval);
-        usb_unanchor_urb(urb);
-        goto error;
+    usb_anchor_urb(async->urb, &ddata->async_anchor);
+    rc = usb_submit_urb(async->urb, GFP_KERNEL);
+    if (rc < 0) { usb_unanchor_urb(async->urb); }
+    up_read(&ddata->io_rwsem);
+    if (rc < 0) {
+        printk(KERN_INFO KBUILD_MODNAME ": error submitting async urb %d.\n", rc);
+        goto unlist;
     }
-    // release our reference to this urb, the USB core will eventually free it entirely
-    usb_free_urb(urb);
-    return writesize;
+    return ACCESIO_SUCCESS;
+    unlist:
+        spin_lock_irq(&ddata->async_lock);
+        list_del(&async->list);
+        spin_unlock_irq(&ddata->async_lock);
+        accesio_usb_async_free(ddata, async);
+        return rc;
     error:
-        if (urb) {
-            usb_free_coherent(dev->udev, writesize, buf, urb->transfer_dma);
-            usb_free_urb(urb);
+        if (async->urb) { usb_free_urb(async->urb); }
+        kfree(buffer);
+        kfree(async);
+        return rc;
+}
+
+static inline int accesio_usb_ioctl_internal_async_reap(accesio_usb_device_info* ddata, struct file* filp, unsigned long arg, bool nonblock)
+{
+    int rc = 0;
+    accesio_usb_async* async = NULL;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_usb_async_request)) == 0) { return -EACCES; }
+    if (!nonblock) {
+        // nothing in flight would never complete, don't wait on it
+        rc = wait_event_interruptible(ddata->async_wait, accesio_usb_async_ready(ddata, filp));
+        if (rc < 0) { return rc; }
+    }
+    spin_lock_irq(&ddata->async_lock);
+    async = accesio_usb_async_find(&ddata->async_done, filp);
+    if (async != NULL) { list_del(&async->list); }
+    spin_unlock_irq(&ddata->async_lock);
+    if (async == NULL) { return (nonblock ? -EAGAIN : -ENODATA); }
+    if (async->request.direction == ACCESIO_USB_DIR_IN && async->request.actual_length != 0 &&
+        copy_to_user(async->request.data, async->urb->transfer_buffer, async->request.actual_length) != 0)
+    {
+        rc = -EFAULT;
+    }
+    if (rc == 0 && copy_to_user((accesio_usb_async_request*)arg, &async->request, sizeof(accesio_usb_async_request)) != 0) { rc = -EIO; }
+    accesio_usb_async_free(ddata, async);
+    return rc;
+}
+
+/* Unlinks the transfer without waiting, it is reaped with -ECONNRESET (or
+ * its real status if it completed first). */
+static inline int accesio_usb_ioctl_internal_async_discard(accesio_usb_device_info* ddata, struct file* filp, unsigned long arg)
+{
+    uint64_t tag = 0;
+    struct urb* urb = NULL;
+    accesio_usb_async* async = NULL;
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(uint64_t)) == 0) { return -EACCES; }
+    if (copy_from_user(&tag, (uint64_t*)arg, sizeof(uint64_t)) != 0) { return -EIO; }
+    spin_lock_irq(&ddata->async_lock);
+    list_for_each_entry(async, &ddata->async_pending, list) {
+        if (async->request.tag == tag && async->owner == filp) {
+            urb = usb_get_urb(async->urb);
+            break;
         }
-        up(&dev->limit_sem);
-    exit:
-        return retval;
+    }
+    spin_unlock_irq(&ddata->async_lock);
+    if (urb == NULL) { return -EINVAL; }
+    usb_unlink_urb(urb);
+    usb_free_urb(urb);
+    return ACCESIO_SUCCESS;
 }
 
 static void accesio_usb_ioctl_set_endpoint_info(accesio_usb_ep* ep, accesio_usb_endpoint* devep)
@@ -1009,7 +2046,7 @@ static inline int accesio_usb_ioctl_internal_get_device_info(accesio_usb_device_
     // usb_device_info data
     info.errors = ddata->errors;
     info.ongoing_read = ddata->ongoing_read;
-    info.ctrl_msg = ddata->ctrl_msg;
+    info.ctrl_msg = (atomic_read(&ddata->ctrl_msg) != 0);
     info.device_index = ddata->device_index;
     info.product_id = ddata->product_id;
     // kernel device information
@@ -1049,6 +2086,500 @@ static inline int accesio_usb_ioctl_internal_get_device_info(accesio_usb_device_
     return ACCESIO_SUCCESS;
 }
 
+static int accesio_usb_ioctl_set_buffer_stats(accesio_usb_buffer_stats* stats, accesio_usb_endpoint_info* ep)
+{
+    int rc = mutex_lock_interruptible(&ep->lock);
+    if (rc < 0) { return rc; }
+    stats->reuses = ep->bounce.reuses;
+    stats->grows = ep->bounce.grows;
+    stats->size = ep->bounce.size;
+    mutex_unlock(&ep->lock);
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_usb_ioctl_internal_bounce_stats(accesio_usb_device_info* ddata, unsigned long arg)
+{
+    int rc = 0;
+    accesio_usb_bounce_stats stats;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_usb_bounce_stats)) == 0) { return -EACCES; }
+    memset(&stats, 0, sizeof(accesio_usb_bounce_stats));
+    if ((rc = accesio_usb_ioctl_set_buffer_stats(&stats.bulk_in, &ddata->endpoints.bulk.in)) < 0 ||
+        (rc = accesio_usb_ioctl_set_buffer_stats(&stats.bulk_out, &ddata->endpoints.bulk.out)) < 0 ||
+        (rc = accesio_usb_ioctl_set_buffer_stats(&stats.control_in, &ddata->endpoints.control.in)) < 0 ||
+        (rc = accesio_usb_ioctl_set_buffer_stats(&stats.control_out, &ddata->endpoints.control.out)) < 0)
+    {
+        return rc;
+    }
+    if (copy_to_user((accesio_usb_bounce_stats*)arg, &stats, sizeof(accesio_usb_bounce_stats)) != 0) { return -EIO; }
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_usb_ioctl_internal_bulk_transfer(accesio_usb_device_info* ddata, unsigned long arg)
+{
+    int rc = 0;
+    accesio_usb_bulk_transfer transfer;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_usb_bulk_transfer)) == 0) { return -EACCES; }
+    if (copy_from_user(&transfer, (accesio_usb_bulk_transfer*)arg, sizeof(accesio_usb_bulk_transfer)) != 0) { return -EIO; }
+    if (transfer.data == NULL || transfer.length == 0 || transfer.length > ACCESIO_USB_ZEROCOPY_MAX) { return -EINVAL; }
+    if (transfer.direction != ACCESIO_USB_DIR_IN && transfer.direction != ACCESIO_USB_DIR_OUT) { return -EINVAL; }
+    if (transfer.timeout_ms == 0) { transfer.timeout_ms = ACCESIO_USB_TIMEOUT_DEFAULT; }
+    transfer.actual_length = 0;
+    if (transfer.length >= ACCESIO_USB_ZEROCOPY_MIN) {
+        rc = accesio_usb_bulk_sg(ddata, &transfer);
+    } else if (transfer.direction == ACCESIO_USB_DIR_IN) {
+        rc = accesio_usb_bulk_read(ddata, transfer.data, transfer.length, true, transfer.timeout_ms, &transfer.actual_length);
+    } else {
+        rc = accesio_usb_bulk_msg(ddata, transfer.data, transfer.length, true, transfer.timeout_ms, &transfer.actual_length);
+    }
+    if (copy_to_user((accesio_usb_bulk_transfer*)arg, &transfer, sizeof(accesio_usb_bulk_transfer)) != 0) { return -EIO; }
+    return rc;
+}
+
+static inline int accesio_usb_ioctl_internal_stream_start(accesio_usb_device_info* ddata, struct file* filp, unsigned long arg, bool in)
+{
+    int rc = 0;
+    uint32_t i = 0;
+    accesio_usb_stream_config config;
+    accesio_usb_stream* stream = (in ? &ddata->stream_in : &ddata->stream_out);
+    accesio_usb_endpoint_info* ep = (in ? &ddata->endpoints.bulk.in : &ddata->endpoints.bulk.out);
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_usb_stream_config)) == 0) { return -EACCES; }
+    if (copy_from_user(&config, (accesio_usb_stream_config*)arg, sizeof(accesio_usb_stream_config)) != 0) { return -EIO; }
+    if (!ep->address) { return -ENXIO; }
+    rc = mutex_lock_interruptible(&stream->lock);
+    if (rc < 0) { return rc; }
+    // a mapped ring stays until the application unmaps it, and another file's stream runs till it stops it
+    if (atomic_read(&stream->mapped) != 0 || (stream->running && stream->owner != filp)) {
+        mutex_unlock(&stream->lock);
+        return -EBUSY;
+    }
+    accesio_usb_stream_stop(ddata, stream);
+    if (in && !kfifo_initialized(&stream->stamps)) {
+        rc = kfifo_alloc(&stream->stamps, ACCESIO_USB_STREAM_STAMPS, GFP_KERNEL);
+        if (rc < 0) {
+            mutex_unlock(&stream->lock);
+            return rc;
+        }
+    }
+    rc = accesio_usb_stream_alloc(ddata, stream, &config, ep->buffer_size, false);
+    if (rc == ACCESIO_SUCCESS) {
+        for (i = 0; i < stream->urb_count; ++i) {
+            usb_fill_bulk_urb(stream->urbs[i],
+                              ddata->udev,
+                              (in ? usb_rcvbulkpipe(ddata->udev, ep->address) : usb_sndbulkpipe(ddata->udev, ep->address)),
+                              stream->urbs[i]->transfer_buffer,
+                              stream->urb_size,
+                              (in ? accesio_usb_stream_in_callback : accesio_usb_stream_out_callback),
+                              ddata);
+        }
+        rc = accesio_usb_stream_submit(ddata, stream, in);
+    }
+    if (rc < 0) {
+        accesio_usb_stream_stop(ddata, stream);
+    } else {
+        stream->owner = filp;
+    }
+    mutex_unlock(&stream->lock);
+    return rc;
+}
+
+// only the file that started the stream stops it
+static inline int accesio_usb_ioctl_internal_stream_stop(accesio_usb_device_info* ddata, struct file* filp, accesio_usb_stream* stream)
+{
+    int rc = mutex_lock_interruptible(&stream->lock);
+    if (rc < 0) { return rc; }
+    if (stream->owner != NULL && stream->owner != filp) {
+        mutex_unlock(&stream->lock);
+        return -EPERM;
+    }
+    accesio_usb_stream_stop(ddata, stream);
+    mutex_unlock(&stream->lock);
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_usb_ioctl_internal_stream_status(accesio_usb_stream* stream, unsigned long arg)
+{
+    uint32_t available = 0;
+    accesio_usb_stream_status status;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_usb_stream_status)) == 0) { return -EACCES; }
+    memset(&status, 0, sizeof(accesio_usb_stream_status));
+    available = accesio_usb_stream_fill(stream);
+    spin_lock_irq(&stream->urb_lock);
+    status.bytes = stream->bytes;
+    status.overruns = stream->overruns;
+    status.underruns = stream->underruns;
+    status.errors = stream->errors;
+    status.urbs = stream->urbs_done;
+    status.available = available;
+    status.ring_size = stream->ring_size;
+    status.error = stream->error;
+    status.running = stream->running;
+    spin_unlock_irq(&stream->urb_lock);
+    if (copy_to_user((accesio_usb_stream_status*)arg, &status, sizeof(accesio_usb_stream_status)) != 0) { return -EIO; }
+    return ACCESIO_SUCCESS;
+}
+
+/* The isochronous endpoint usually only has bandwidth in a non-zero alternate
+ * setting, which is selected for the stream's lifetime. */
+static inline int accesio_usb_ioctl_internal_iso_start(accesio_usb_device_info* ddata, struct file* filp, unsigned long arg)
+{
+    int rc = 0;
+    int x = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+    uint32_t packet = 0;
+    uint32_t interval = 0;
+    unsigned int alt = 0;
+    uint8_t altsetting = 0;
+    struct urb* purb = NULL;
+    struct usb_endpoint_descriptor* epd = NULL;
+    accesio_usb_stream_config config;
+    accesio_usb_stream* stream = &ddata->stream_iso;
+    accesio_usb_endpoint_info* ep = &ddata->endpoints.isochronous.in;
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_usb_stream_config)) == 0) { return -EACCES; }
+    if (copy_from_user(&config, (accesio_usb_stream_config*)arg, sizeof(accesio_usb_stream_config)) != 0) { return -EIO; }
+    if (!ep->address) { return -ENXIO; }
+    rc = mutex_lock_interruptible(&stream->lock);
+    if (rc < 0) { return rc; }
+    if (atomic_read(&stream->mapped) != 0 || (stream->running && stream->owner != filp)) {
+        mutex_unlock(&stream->lock);
+        return -EBUSY;
+    }
+    accesio_usb_iso_stop(ddata);
+    down_read(&ddata->io_rwsem);
+    for (alt = 0; ddata->interface && alt < ddata->interface->num_altsetting && packet == 0; ++alt) {
+        for (x = 0; x < ddata->interface->altsetting[alt].desc.bNumEndpoints; ++x) {
+            epd = &ddata->interface->altsetting[alt].endpoint[x].desc;
+            if (epd->bEndpointAddress != ep->address) { continue; }
+            // high-bandwidth endpoints move up to three packets per microframe
+            packet = usb_endpoint_maxp(epd) * usb_endpoint_maxp_mult(epd);
+            interval = 1 << (clamp_t(uint8_t, epd->bInterval, 1, 16) - 1);
+            altsetting = ddata->interface->altsetting[alt].desc.bAlternateSetting;
+            break;
+        }
+    }
+    rc = (ddata->interface ? (packet ? 0 : -ENXIO) : -ENODEV);
+    if (rc == 0 && altsetting != 0) {
+        rc = usb_set_interface(ddata->udev, ddata->interface->cur_altsetting->desc.bInterfaceNumber, altsetting);
+    }
+    up_read(&ddata->io_rwsem);
+    if (rc < 0) { goto exit; }
+    stream->altsetting = altsetting;
+    stream->sequence = 0;
+    stream->period_ns = (uint64_t)interval * (ddata->udev->speed >= USB_SPEED_HIGH ? 125000 : 1000000);
+    if (config.urb_size == 0) { config.urb_size = packet * ACCESIO_USB_ISO_PACKETS_DEFAULT; }
+    rc = accesio_usb_stream_alloc(ddata, stream, &config, packet, true);
+    for (i = 0; rc == ACCESIO_SUCCESS && i < stream->urb_count; ++i) {
+        purb = stream->urbs[i];
+        purb->dev = ddata->udev;
+        purb->pipe = usb_rcvisocpipe(ddata->udev, ep->address);
+        purb->interval = interval;
+        purb->transfer_flags |= URB_ISO_ASAP;
+        purb->transfer_buffer_length = stream->urb_size;
+        purb->number_of_packets = stream->urb_size / packet;
+        purb->complete = accesio_usb_stream_iso_callback;
+        purb->context = ddata;
+        for (j = 0; j < purb->number_of_packets; ++j) {
+            purb->iso_frame_desc[j].offset = j * packet;
+            purb->iso_frame_desc[j].length = packet;
+        }
+    }
+    if (rc == ACCESIO_SUCCESS) { rc = accesio_usb_stream_submit(ddata, stream, true); }
+    exit:
+        if (rc < 0) {
+            accesio_usb_iso_stop(ddata);
+        } else {
+            stream->owner = filp;
+        }
+        mutex_unlock(&stream->lock);
+        return rc;
+}
+
+static inline int accesio_usb_ioctl_internal_iso_stop(accesio_usb_device_info* ddata, struct file* filp)
+{
+    int rc = mutex_lock_interruptible(&ddata->stream_iso.lock);
+    if (rc < 0) { return rc; }
+    if (ddata->stream_iso.owner != NULL && ddata->stream_iso.owner != filp) {
+        mutex_unlock(&ddata->stream_iso.lock);
+        return -EPERM;
+    }
+    accesio_usb_iso_stop(ddata);
+    mutex_unlock(&ddata->stream_iso.lock);
+    return ACCESIO_SUCCESS;
+}
+
+/* Reads whole packet records without blocking, a first record larger than the
+ * buffer is -EMSGSIZE so the caller can retry with a bigger one. */
+static inline int accesio_usb_ioctl_internal_iso_read(accesio_usb_device_info* ddata, unsigned long arg)
+{
+    int rc = 0;
+    uint32_t tail, available, stride;
+    accesio_usb_iso_packet packet;
+    accesio_usb_iso_packets request;
+    accesio_usb_stream* stream = &ddata->stream_iso;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_usb_iso_packets)) == 0) { return -EACCES; }
+    if (copy_from_user(&request, (accesio_usb_iso_packets*)arg, sizeof(accesio_usb_iso_packets)) != 0) { return -EIO; }
+    if (request.data == NULL || request.length == 0) { return -EINVAL; }
+    request.actual_length = 0;
+    request.packets = 0;
+    rc = mutex_lock_interruptible(&stream->io_lock);
+    if (rc < 0) { return rc; }
+    if (!stream->control) {
+        rc = -ENODATA;
+        goto exit;
+    }
+    tail = stream->control->tail;
+    available = accesio_usb_stream_used(stream);
+    while (available >= sizeof(accesio_usb_iso_packet)) {
+        accesio_usb_stream_peek(stream, tail, &packet, sizeof(accesio_usb_iso_packet));
+        stride = sizeof(accesio_usb_iso_packet) + ALIGN(packet.length, 8);
+        if (stride > request.length - request.actual_length) {
+            if (request.packets == 0) { rc = -EMSGSIZE; }
+            break;
+        }
+        if (accesio_usb_stream_copy_out(stream, tail, (char*)request.data + request.actual_length, stride)) {
+            rc = -EFAULT;
+            break;
+        }
+        tail += stride;
+        available -= stride;
+        request.actual_length += stride;
+        ++request.packets;
+    }
+    smp_store_release(&stream->control->tail, tail);
+    if (rc == 0 && request.packets == 0) { rc = (READ_ONCE(stream->running) ? -EAGAIN : -ENODATA); }
+    exit:
+        mutex_unlock(&stream->io_lock);
+        if (copy_to_user((accesio_usb_iso_packets*)arg, &request, sizeof(accesio_usb_iso_packets)) != 0) { return -EIO; }
+        return rc;
+}
+
+static inline int accesio_usb_ioctl_internal_stream_timestamps(accesio_usb_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    unsigned int count = 0;
+    accesio_usb_stream_timestamps request;
+    accesio_usb_stream_timestamp* stamps = NULL;
+    accesio_usb_stream* stream = &ddata->stream_in;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_usb_stream_timestamps)) == 0) { return -EACCES; }
+    if (copy_from_user(&request, (accesio_usb_stream_timestamps*)arg, sizeof(accesio_usb_stream_timestamps)) != 0) { return -EIO; }
+    if (request.count == 0 || request.stamps == NULL) { return -EINVAL; }
+    ret = mutex_lock_interruptible(&stream->lock);
+    if (ret < 0) { return ret; }
+    if (!kfifo_initialized(&stream->stamps)) { ret = -ENODATA; goto exit; }
+    count = min(request.count, kfifo_size(&stream->stamps));
+    stamps = kmalloc_array(count, sizeof(accesio_usb_stream_timestamp), GFP_KERNEL);
+    if (stamps == NULL) { ret = -ENOMEM; goto exit; }
+    spin_lock_irq(&stream->urb_lock);
+    count = kfifo_out(&stream->stamps, stamps, count);
+    request.dropped = stream->stamps_dropped;
+    spin_unlock_irq(&stream->urb_lock);
+    if (count != 0 && copy_to_user(request.stamps, stamps, (count * sizeof(accesio_usb_stream_timestamp))) != 0) { ret = -EIO; goto exit; }
+    if (copy_to_user((accesio_usb_stream_timestamps*)arg, &request, sizeof(accesio_usb_stream_timestamps)) != 0) { ret = -EIO; goto exit; }
+    ret = count;
+    exit:
+        kfree(stamps);
+        mutex_unlock(&stream->lock);
+        return ret;
+}
+
+/* The rate is the slope between the oldest and newest completion kept, the
+ * reference point their centroid, which averages the completion latency
+ * jitter out of the offset. */
+static inline int accesio_usb_ioctl_internal_stream_clock(accesio_usb_device_info* ddata, unsigned long arg)
+{
+    uint32_t i = 0;
+    uint32_t oldest, newest;
+    uint64_t span_bytes, span_ns, whole, rem;
+    uint64_t sum_bytes = 0;
+    uint64_t sum_ns = 0;
+    accesio_usb_stream* stream = NULL;
+    accesio_usb_clock* clock = NULL;
+    accesio_usb_stream_clock request;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_usb_stream_clock)) == 0) { return -EACCES; }
+    if (copy_from_user(&request, (accesio_usb_stream_clock*)arg, sizeof(accesio_usb_stream_clock)) != 0) { return -EIO; }
+    switch (request.stream) {
+        case ACCESIO_USB_STREAM_IN: stream = &ddata->stream_in; break;
+        case ACCESIO_USB_STREAM_OUT: stream = &ddata->stream_out; break;
+        default: return -EINVAL;
+    }
+    clock = &stream->clock;
+    spin_lock_irq(&stream->urb_lock);
+    request.points = clock->count;
+    oldest = (clock->next + ACCESIO_USB_CLOCK_POINTS - clock->count) % ACCESIO_USB_CLOCK_POINTS;
+    newest = (clock->next + ACCESIO_USB_CLOCK_POINTS - 1) % ACCESIO_USB_CLOCK_POINTS;
+    span_bytes = clock->offset[newest] - clock->offset[oldest];
+    span_ns = clock->ns[newest] - clock->ns[oldest];
+    for (i = 0; clock->count >= 2 && i < clock->count; ++i) {
+        sum_bytes += clock->offset[(oldest + i) % ACCESIO_USB_CLOCK_POINTS] - clock->offset[oldest];
+        sum_ns += clock->ns[(oldest + i) % ACCESIO_USB_CLOCK_POINTS] - clock->ns[oldest];
+    }
+    if (clock->count >= 2) {
+        request.ref_offset = clock->offset[oldest] + div64_u64(sum_bytes, clock->count);
+        request.ref_ns = clock->ns[oldest] + div64_u64(sum_ns, clock->count);
+    }
+    spin_unlock_irq(&stream->urb_lock);
+    // too few completions yet, or none that moved data
+    if (request.points < 2 || span_bytes == 0 || span_ns == 0) { return -EAGAIN; }
+    whole = div64_u64_rem(span_ns, span_bytes, &rem);
+    request.ns_per_byte_q32 = (whole << 32) + div64_u64(rem << 32, span_bytes);
+    request.bytes_per_second = div64_u64(span_bytes * 1000000000ULL, span_ns);
+    if (copy_to_user((accesio_usb_stream_clock*)arg, &request, sizeof(accesio_usb_stream_clock)) != 0) { return -EIO; }
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_usb_ioctl_internal_write_pool_resize(accesio_usb_device_info* ddata, unsigned long arg)
+{
+    int rc = 0;
+    uint32_t i = 0;
+    uint32_t held = 0;
+    uint32_t depth = 0;
+    accesio_usb_write_pool* pool = &ddata->write_pool;
+    accesio_usb_write_pool fresh;
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(uint32_t)) == 0) { return -EACCES; }
+    if (copy_from_user(&depth, (uint32_t*)arg, sizeof(uint32_t)) != 0) { return -EIO; }
+    if (depth == 0 || depth > ACCESIO_USB_WRITE_POOL_MAX) { return -EINVAL; }
+    rc = mutex_lock_interruptible(&pool->resize_lock);
+    if (rc < 0) { return rc; }
+    memset(&fresh, 0, sizeof(accesio_usb_write_pool));
+    rc = accesio_usb_write_pool_alloc(ddata, &fresh, depth);
+    if (rc < 0) { goto exit; }
+    // holding every count waits out the writes in flight and keeps new ones away
+    for (held = 0; held < pool->depth; ++held) {
+        rc = down_interruptible(&ddata->limit_sem);
+        if (rc < 0) { break; }
+    }
+    if (rc == 0) {
+        spin_lock_irq(&pool->lock);
+        swap(pool->entries, fresh.entries);
+        swap(pool->free, fresh.free);
+        swap(pool->depth, fresh.depth);
+        swap(pool->free_count, fresh.free_count);
+        spin_unlock_irq(&pool->lock);
+        held = pool->depth;
+    }
+    for (i = 0; i < held; ++i) { up(&ddata->limit_sem); }
+    // the old pool on success, the new one otherwise
+    accesio_usb_write_pool_free(ddata, &fresh);
+    exit:
+        mutex_unlock(&pool->resize_lock);
+        return rc;
+}
+
+static inline int accesio_usb_ioctl_internal_write_pool_stats(accesio_usb_device_info* ddata, unsigned long arg)
+{
+    accesio_usb_write_pool_stats stats;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_usb_write_pool_stats)) == 0) { return -EACCES; }
+    memset(&stats, 0, sizeof(accesio_usb_write_pool_stats));
+    spin_lock_irq(&ddata->write_pool.lock);
+    stats.writes = ddata->write_pool.writes;
+    stats.exhausted = ddata->write_pool.exhausted;
+    stats.depth = ddata->write_pool.depth;
+    stats.available = ddata->write_pool.free_count;
+    spin_unlock_irq(&ddata->write_pool.lock);
+    if (copy_to_user((accesio_usb_write_pool_stats*)arg, &stats, sizeof(accesio_usb_write_pool_stats)) != 0) { return -EIO; }
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_usb_ioctl_internal_write_coalesce(accesio_usb_device_info* ddata, unsigned long arg)
+{
+    int rc = 0;
+    accesio_usb_write_coalesce config;
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_usb_write_coalesce)) == 0) { return -EACCES; }
+    if (copy_from_user(&config, (accesio_usb_write_coalesce*)arg, sizeof(accesio_usb_write_coalesce)) != 0) { return -EIO; }
+    if (config.delay_us == 0) { config.delay_us = ACCESIO_USB_COALESCE_DELAY_DEFAULT; }
+    if (config.size > ACCESIO_USB_MAX_XFR || config.delay_us > ACCESIO_USB_COALESCE_DELAY_MAX) { return -EINVAL; }
+    rc = mutex_lock_interruptible(&ddata->coalesce.lock);
+    if (rc < 0) { return rc; }
+    accesio_usb_coalesce_push(ddata);
+    WRITE_ONCE(ddata->coalesce.size, config.size);
+    ddata->coalesce.delay_us = config.delay_us;
+    mutex_unlock(&ddata->coalesce.lock);
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_usb_ioctl_internal_interrupt_start(accesio_usb_device_info* ddata, struct file* filp)
+{
+    int rc = 0;
+    accesio_usb_interrupt* interrupt = &ddata->interrupt;
+    accesio_usb_endpoint_info* ep = &ddata->endpoints.interrupt.in;
+    if (!ep->urb || !ep->address) { return -ENXIO; }
+    rc = mutex_lock_interruptible(&interrupt->lock);
+    if (rc < 0) { return rc; }
+    accesio_usb_interrupt_stop(ddata);
+    if (!kfifo_initialized(&interrupt->reports)) {
+        rc = kfifo_alloc(&interrupt->reports, ACCESIO_USB_INTERRUPT_QUEUE, GFP_KERNEL);
+        if (rc < 0) { goto exit; }
+    }
+    spin_lock_irq(&interrupt->queue_lock);
+    kfifo_reset(&interrupt->reports);
+    interrupt->sequence = 0;
+    interrupt->dropped = 0;
+    interrupt->error = 0;
+    interrupt->running = true;
+    spin_unlock_irq(&interrupt->queue_lock);
+    usb_fill_int_urb(ep->urb,
+                     ddata->udev,
+                     usb_rcvintpipe(ddata->udev, ep->address),
+                     ep->buffer,
+                     ep->buffer_size,
+                     accesio_usb_interrupt_callback,
+                     ddata,
+                     ep->interval);
+    // this lock makes sure we don't submit URBs to gone devices
+    down_read(&ddata->io_rwsem);
+    rc = (ddata->interface ? usb_submit_urb(ep->urb, GFP_KERNEL) : -ENODEV);
+    up_read(&ddata->io_rwsem);
+    if (rc < 0) {
+        spin_lock_irq(&interrupt->queue_lock);
+        interrupt->running = false;
+        spin_unlock_irq(&interrupt->queue_lock);
+    } else {
+        interrupt->owner = filp;
+    }
+    exit:
+        mutex_unlock(&interrupt->lock);
+        return rc;
+}
+
+static inline int accesio_usb_ioctl_internal_interrupt_stop(accesio_usb_device_info* ddata)
+{
+    int rc = mutex_lock_interruptible(&ddata->interrupt.lock);
+    if (rc < 0) { return rc; }
+    accesio_usb_interrupt_stop(ddata);
+    mutex_unlock(&ddata->interrupt.lock);
+    return ACCESIO_SUCCESS;
+}
+
+static inline int accesio_usb_ioctl_internal_interrupt_read(accesio_usb_device_info* ddata, unsigned long arg)
+{
+    int ret = 0;
+    unsigned int count = 0;
+    accesio_usb_interrupt_reports request;
+    accesio_usb_interrupt_report* reports = NULL;
+    accesio_usb_interrupt* interrupt = &ddata->interrupt;
+    if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(accesio_usb_interrupt_reports)) == 0) { return -EACCES; }
+    if (copy_from_user(&request, (accesio_usb_interrupt_reports*)arg, sizeof(accesio_usb_interrupt_reports)) != 0) { return -EIO; }
+    if (request.count == 0 || request.reports == NULL) { return -EINVAL; }
+    ret = mutex_lock_interruptible(&interrupt->lock);
+    if (ret < 0) { return ret; }
+    if (!kfifo_initialized(&interrupt->reports)) { ret = -ENODATA; goto exit; }
+    count = min(request.count, kfifo_size(&interrupt->reports));
+    reports = kmalloc_array(count, sizeof(accesio_usb_interrupt_report), GFP_KERNEL);
+    if (reports == NULL) { ret = -ENOMEM; goto exit; }
+    spin_lock_irq(&interrupt->queue_lock);
+    count = kfifo_out(&interrupt->reports, reports, count);
+    request.dropped = interrupt->dropped;
+    request.error = interrupt->error;
+    spin_unlock_irq(&interrupt->queue_lock);
+    if (count != 0 && copy_to_user(request.reports, reports, (count * sizeof(accesio_usb_interrupt_report))) != 0) { ret = -EIO; goto exit; }
+    if (copy_to_user((accesio_usb_interrupt_reports*)arg, &request, sizeof(accesio_usb_interrupt_reports)) != 0) { ret = -EIO; goto exit; }
+    ret = count;
+    exit:
+        kfree(reports);
+        mutex_unlock(&interrupt->lock);
+        return ret;
+}
+
 static inline int accesio_usb_ioctl_internal_write(accesio_usb_device_info* ddata, unsigned long arg)
 {
     accesio_usb_ioctl_packet iodata;
@@ -1056,9 +2587,9 @@ static inline int accesio_usb_ioctl_internal_write(accesio_usb_device_info* ddat
     if (copy_from_user(&iodata, (accesio_usb_ioctl_packet*)arg, sizeof(accesio_usb_ioctl_packet)) != 0) { return -EIO; }
     switch (iodata.msg_type) {
         case ACCESIO_USB_IOCTL_BULK_MSG:
-            return accesio_usb_bulk_msg(ddata, iodata.data, iodata.data_len);
+            return accesio_usb_bulk_msg(ddata, iodata.data, iodata.data_len, true, USB_CTRL_SET_TIMEOUT, NULL);
         case ACCESIO_USB_IOCTL_CTRL_MSG:
-            return accesio_usb_ctrl_msg(ddata, iodata.request, iodata.value, iodata.index, iodata.data, iodata.data_len);
+            return accesio_usb_ctrl_msg(ddata, iodata.request, iodata.value, iodata.index, iodata.data, iodata.data_len, true);
     }
     return -EINVAL;
 }
@@ -1071,15 +2602,72 @@ static inline int accesio_usb_ioctl_internal_read(accesio_usb_device_info* ddata
     if (copy_from_user(&iodata, (accesio_usb_ioctl_packet*)arg, sizeof(accesio_usb_ioctl_packet)) != 0) { return -EIO; }
     switch (iodata.msg_type) {
         case ACCESIO_USB_IOCTL_BULK_MSG:
-            rc = accesio_usb_bulk_read(ddata, iodata.data, iodata.data_len);
+            rc = accesio_usb_bulk_read(ddata, iodata.data, iodata.data_len, true, USB_CTRL_SET_TIMEOUT, NULL);
+            break;
         case ACCESIO_USB_IOCTL_CTRL_MSG:
-            rc = accesio_usb_ctrl_read(ddata, iodata.request, iodata.value, iodata.index, iodata.data, iodata.data_len);
+            rc = accesio_usb_ctrl_read(ddata, iodata.request, iodata.value, iodata.index, iodata.data, iodata.data_len, true);
+            break;
     }
     if (rc < 0) { return rc; }
     if (copy_to_user((accesio_usb_ioctl_packet*)arg, &iodata, sizeof(accesio_usb_ioctl_packet)) != 0) { return -EIO; }
     return ACCESIO_SUCCESS;
 }
 
+/* Runs the transfers back to back with both control directions locked once,
+ * returns the number done, each one's byte count or error is in its status. */
+static inline int accesio_usb_ioctl_internal_control_batch(accesio_usb_device_info* ddata, unsigned long arg)
+{
+    int rc = 0;
+    uint32_t i = 0;
+    uint32_t done = 0;
+    accesio_usb_control_batch batch;
+    accesio_usb_control_transfer* transfers = NULL;
+    if (ACCES_AOK(VERIFY_READ, arg, sizeof(accesio_usb_control_batch)) == 0) { return -EACCES; }
+    if (copy_from_user(&batch, (accesio_usb_control_batch*)arg, sizeof(accesio_usb_control_batch)) != 0) { return -EIO; }
+    if (batch.transfers == NULL || batch.count == 0 || batch.count > ACCESIO_USB_CONTROL_BATCH_MAX) { return -EINVAL; }
+    transfers = kmalloc_array(batch.count, sizeof(accesio_usb_control_transfer), GFP_KERNEL);
+    if (!transfers) { return -ENOMEM; }
+    if (copy_from_user(transfers, batch.transfers, batch.count * sizeof(accesio_usb_control_transfer)) != 0) {
+        rc = -EFAULT;
+        goto free;
+    }
+    for (i = 0; i < batch.count; ++i) {
+        if (transfers[i].direction != ACCESIO_USB_DIR_IN && transfers[i].direction != ACCESIO_USB_DIR_OUT) {
+            rc = -EINVAL;
+            goto free;
+        }
+        transfers[i].status = -ECANCELED;
+    }
+    // always in before out
+    rc = mutex_lock_interruptible(&ddata->endpoints.control.in.lock);
+    if (rc < 0) { goto free; }
+    rc = accesio_usb_io_lock(ddata, &ddata->endpoints.control.out);
+    if (rc < 0) {
+        mutex_unlock(&ddata->endpoints.control.in.lock);
+        goto free;
+    }
+    for (done = 0; done < batch.count; ++done) {
+        transfers[done].status = accesio_usb_ctrl_transfer(ddata,
+                                                           (transfers[done].direction == ACCESIO_USB_DIR_IN),
+                                                           transfers[done].request,
+                                                           transfers[done].value,
+                                                           transfers[done].index,
+                                                           transfers[done].data,
+                                                           transfers[done].length,
+                                                           true);
+        if (transfers[done].status < 0 && batch.stop_on_error) {
+            ++done;
+            break;
+        }
+    }
+    accesio_usb_io_unlock(ddata, &ddata->endpoints.control.out);
+    mutex_unlock(&ddata->endpoints.control.in.lock);
+    rc = (copy_to_user(batch.transfers, transfers, batch.count * sizeof(accesio_usb_control_transfer)) != 0 ? -EIO : (int)done);
+    free:
+        kfree(transfers);
+        return rc;
+}
+
 static int accesio_usb_ioctl_internal(struct file* filp, unsigned int cmd, unsigned long arg)
 {
     accesio_usb_device_info* ddata = filp->private_data;
@@ -1101,10 +2689,82 @@ static int accesio_usb_ioctl_internal(struct file* filp, unsigned int cmd, unsig
             return ddata->ongoing_read;
 
         case ACCESIO_IOCTL_GET_USB_IS_WRITING:
-            return ddata->ctrl_msg;
+            return (atomic_read(&ddata->ctrl_msg) != 0);
 
         case ACCESIO_IOCTL_GET_USB_IS_IO:
-            return ddata->ongoing_read || ddata->ctrl_msg;
+            return ddata->ongoing_read || (atomic_read(&ddata->ctrl_msg) != 0);
+
+        case ACCESIO_IOCTL_USB_BOUNCE_STATS:
+            return accesio_usb_ioctl_internal_bounce_stats(ddata, arg);
+
+        case ACCESIO_IOCTL_USB_BULK_TRANSFER:
+            return accesio_usb_ioctl_internal_bulk_transfer(ddata, arg);
+
+        case ACCESIO_IOCTL_USB_ASYNC_SUBMIT:
+            return accesio_usb_ioctl_internal_async_submit(ddata, filp, arg);
+
+        case ACCESIO_IOCTL_USB_ASYNC_REAP:
+            return accesio_usb_ioctl_internal_async_reap(ddata, filp, arg, false);
+
+        case ACCESIO_IOCTL_USB_ASYNC_REAP_NONBLOCK:
+            return accesio_usb_ioctl_internal_async_reap(ddata, filp, arg, true);
+
+        case ACCESIO_IOCTL_USB_ASYNC_DISCARD:
+            return accesio_usb_ioctl_internal_async_discard(ddata, filp, arg);
+
+        case ACCESIO_IOCTL_USB_STREAM_IN_START:
+            return accesio_usb_ioctl_internal_stream_start(ddata, filp, arg, true);
+
+        case ACCESIO_IOCTL_USB_STREAM_IN_STOP:
+            return accesio_usb_ioctl_internal_stream_stop(ddata, filp, &ddata->stream_in);
+
+        case ACCESIO_IOCTL_USB_STREAM_IN_STATUS:
+            return accesio_usb_ioctl_internal_stream_status(&ddata->stream_in, arg);
+
+        case ACCESIO_IOCTL_USB_STREAM_OUT_START:
+            return accesio_usb_ioctl_internal_stream_start(ddata, filp, arg, false);
+
+        case ACCESIO_IOCTL_USB_STREAM_OUT_STOP:
+            return accesio_usb_ioctl_internal_stream_stop(ddata, filp, &ddata->stream_out);
+
+        case ACCESIO_IOCTL_USB_STREAM_OUT_STATUS:
+            return accesio_usb_ioctl_internal_stream_status(&ddata->stream_out, arg);
+
+        case ACCESIO_IOCTL_USB_WRITE_POOL_RESIZE:
+            return accesio_usb_ioctl_internal_write_pool_resize(ddata, arg);
+
+        case ACCESIO_IOCTL_USB_WRITE_POOL_STATS:
+            return accesio_usb_ioctl_internal_write_pool_stats(ddata, arg);
+
+        case ACCESIO_IOCTL_USB_INTERRUPT_START:
+            return accesio_usb_ioctl_internal_interrupt_start(ddata, filp);
+
+        case ACCESIO_IOCTL_USB_INTERRUPT_STOP:
+            return accesio_usb_ioctl_internal_interrupt_stop(ddata);
+
+        case ACCESIO_IOCTL_USB_INTERRUPT_READ:
+            return accesio_usb_ioctl_internal_interrupt_read(ddata, arg);
+        case ACCESIO_IOCTL_USB_ISO_START:
+            return accesio_usb_ioctl_internal_iso_start(ddata, filp, arg);
+        case ACCESIO_IOCTL_USB_ISO_STOP:
+            return accesio_usb_ioctl_internal_iso_stop(ddata, filp);
+        case ACCESIO_IOCTL_USB_ISO_STATUS:
+            return accesio_usb_ioctl_internal_stream_status(&ddata->stream_iso, arg);
+        case ACCESIO_IOCTL_USB_ISO_READ:
+            return accesio_usb_ioctl_internal_iso_read(ddata, arg);
+        case ACCESIO_IOCTL_USB_CONTROL_BATCH:
+            return accesio_usb_ioctl_internal_control_batch(ddata, arg);
+        case ACCESIO_IOCTL_USB_WRITE_COALESCE:
+            return accesio_usb_ioctl_internal_write_coalesce(ddata, arg);
+        case ACCESIO_IOCTL_USB_WRITE_FLUSH:
+            return accesio_usb_write_sync(ddata);
+        case ACCESIO_IOCTL_USB_STREAM_IN_TIMESTAMPS:
+            return accesio_usb_ioctl_internal_stream_timestamps(ddata, arg);
+        case ACCESIO_IOCTL_USB_STREAM_CLOCK:
+            return accesio_usb_ioctl_internal_stream_clock(ddata, arg);
+        case ACCESIO_IOCTL_USB_READ_TIMESTAMP:
+            if (ACCES_AOK(VERIFY_WRITE, arg, sizeof(uint64_t)) == 0) { return -EACCES; }
+            return (copy_to_user((uint64_t*)arg, &ddata->endpoints.bulk.in.completed_ns, sizeof(uint64_t)) != 0 ? -EIO : ACCESIO_SUCCESS);
         
         case ACCESIO_IOCTL_GET_DEVICE_IS_PCIE:
             return 0;
@@ -1121,6 +2781,88 @@ static int accesio_usb_ioctl_internal(struct file* filp, unsigned int cmd, unsig
     return -ENOSYS;
 }
 
+/* Readable once a bulk-in read completed with data or an error that read()
+ * will hand back, writable while a write URB is free. A nonblocking read()
+ * that returned -EAGAIN has started the transfer this waits on. */
+static unsigned int accesio_usb_poll(struct file* filp, poll_table* wait)
+{
+    unsigned int mask = 0;
+    accesio_usb_device_info* dev = filp->private_data;
+    if (dev == NULL) { return POLLERR; }
+    poll_wait(filp, &dev->io_wait, wait);
+    poll_wait(filp, &dev->async_wait, wait);
+    poll_wait(filp, &dev->stream_in.wait, wait);
+    poll_wait(filp, &dev->stream_out.wait, wait);
+    poll_wait(filp, &dev->stream_iso.wait, wait);
+    poll_wait(filp, &dev->interrupt.wait, wait);
+    if (!dev->interface) { mask |= (POLLERR | POLLHUP); }
+    spin_lock_irq(&dev->async_lock);
+    if (accesio_usb_async_find(&dev->async_done, filp) != NULL) { mask |= POLLPRI; }
+    spin_unlock_irq(&dev->async_lock);
+    if (kfifo_initialized(&dev->interrupt.reports) && !kfifo_is_empty(&dev->interrupt.reports)) { mask |= POLLPRI; }
+    if (accesio_usb_stream_fill(&dev->stream_in) != 0) { mask |= (POLLIN | POLLRDNORM); }
+    // read() doesn't drain isochronous packets, only ACCESIO_IOCTL_USB_ISO_READ does
+    if (accesio_usb_stream_fill(&dev->stream_iso) != 0) { mask |= POLLPRI; }
+    if (READ_ONCE(dev->stream_out.running)) {
+        if (accesio_usb_stream_fill(&dev->stream_out) <= dev->stream_out.low_water) { mask |= (POLLOUT | POLLWRNORM); }
+    } else if (READ_ONCE(dev->write_pool.free_count) != 0) {
+        mask |= (POLLOUT | POLLWRNORM);
+    }
+    spin_lock_irq(&dev->err_lock);
+    if (!dev->ongoing_read && (dev->endpoints.bulk.in.filled > dev->endpoints.bulk.in.copied || dev->errors)) {
+        mask |= (POLLIN | POLLRDNORM);
+    }
+    spin_unlock_irq(&dev->err_lock);
+    return mask;
+}
+
+static void accesio_usb_vma_open(struct vm_area_struct* vma)
+{
+    accesio_usb_stream* stream = vma->vm_private_data;
+    atomic_inc(&stream->mapped);
+}
+
+static void accesio_usb_vma_close(struct vm_area_struct* vma)
+{
+    accesio_usb_stream* stream = vma->vm_private_data;
+    atomic_dec(&stream->mapped);
+}
+
+static const struct vm_operations_struct accesio_usb_vm_ops = {
+    .open = accesio_usb_vma_open,
+    .close = accesio_usb_vma_close,
+};
+
+/* Maps the bulk-in stream's control page and ring, which must have been set
+ * up by starting the stream, the whole of them at offset 0. The mapping has
+ * to be shared, a private copy of the control page would hide the tail. */
+static int accesio_usb_mmap(struct file* filp, struct vm_area_struct* vma)
+{
+    int rc = 0;
+    accesio_usb_device_info* dev = filp->private_data;
+    accesio_usb_stream* stream = NULL;
+    if (dev == NULL) { return -ENODEV; }
+    stream = &dev->stream_in;
+    if (vma->vm_pgoff != 0 || !(vma->vm_flags & VM_SHARED)) { return -EINVAL; }
+    rc = mutex_lock_interruptible(&stream->lock);
+    if (rc < 0) { return rc; }
+    if (!stream->control) {
+        rc = -ENODATA;
+    } else if ((vma->vm_end - vma->vm_start) != (PAGE_SIZE + PAGE_ALIGN(stream->ring_size))) {
+        rc = -EINVAL;
+    } else {
+        rc = remap_vmalloc_range(vma, stream->control, 0);
+    }
+    if (rc == 0) {
+        ACCES_VM_FLAGS_CLEAR(vma, VM_MAYEXEC);
+        vma->vm_ops = &accesio_usb_vm_ops;
+        vma->vm_private_data = stream;
+        atomic_inc(&stream->mapped);
+    }
+    mutex_unlock(&stream->lock);
+    return rc;
+}
+
 static loff_t accesio_usb_seek(struct file* filp, loff_t offset, int origin)
 {
     /* NOTE: this function could be utilized to signal different modes of
@@ -1153,10 +2895,33 @@ static int accesio_usb_probe(struct usb_interface* interface, const struct usb_d
     dev->device_index = increment_device_id(dev->product_id);
     kref_init(&dev->kref);
     sema_init(&dev->limit_sem, ACCESIO_USB_WIF);
-    mutex_init(&dev->io_mutex);
+    spin_lock_init(&dev->write_pool.lock);
+    mutex_init(&dev->write_pool.resize_lock);
+    mutex_init(&dev->coalesce.lock);
+    ACCES_HRTIMER_SETUP(&dev->coalesce.timer, accesio_usb_coalesce_timeout, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    INIT_WORK(&dev->coalesce.work, accesio_usb_coalesce_work);
+    init_rwsem(&dev->io_rwsem);
+    mutex_init(&dev->endpoints.bulk.in.lock);
+    mutex_init(&dev->endpoints.bulk.out.lock);
+    mutex_init(&dev->endpoints.control.in.lock);
+    mutex_init(&dev->endpoints.control.out.lock);
+    ACCES_HRTIMER_SETUP(&dev->endpoints.bulk.in.sg_timer, accesio_usb_sg_timeout, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    ACCES_HRTIMER_SETUP(&dev->endpoints.bulk.out.sg_timer, accesio_usb_sg_timeout, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
     spin_lock_init(&dev->err_lock);
     init_usb_anchor(&dev->submitted);
+    init_usb_anchor(&dev->async_anchor);
+    atomic_set(&dev->ctrl_msg, 0);
     init_waitqueue_head(&dev->io_wait);
+    INIT_LIST_HEAD(&dev->async_pending);
+    INIT_LIST_HEAD(&dev->async_done);
+    spin_lock_init(&dev->async_lock);
+    init_waitqueue_head(&dev->async_wait);
+    accesio_usb_stream_init(&dev->stream_in);
+    accesio_usb_stream_init(&dev->stream_out);
+    accesio_usb_stream_init(&dev->stream_iso);
+    mutex_init(&dev->interrupt.lock);
+    spin_lock_init(&dev->interrupt.queue_lock);
+    init_waitqueue_head(&dev->interrupt.wait);
     dev->udev = usb_get_dev(interface_to_usbdev(interface));
     dev->interface = interface;
     // set up the endpoint information
@@ -1165,6 +2930,12 @@ static int accesio_usb_probe(struct usb_interface* interface, const struct usb_d
         printk(KERN_INFO KBUILD_MODNAME ": error setting up I/O endpoints, %d.\n", retval);
         goto error;
     }
+    // one write URB per limit_sem count
+    retval = accesio_usb_write_pool_alloc(dev, &dev->write_pool, ACCESIO_USB_WIF);
+    if (retval) {
+        printk(KERN_INFO KBUILD_MODNAME ": error allocating the write URBs, %d.\n", retval);
+        goto error;
+    }
     // save our data pointer in this interface device
     usb_set_intfdata(interface, dev);
     // we can register the device now, as it is ready
@@ -1211,6 +2982,12 @@ static int accesio_usb_suspend(struct usb_interface* intf, pm_message_t message)
     accesio_usb_device_info* dev = usb_get_intfdata(intf);
     if (!dev) { return ACCESIO_SUCCESS; }
     accesio_usb_draw_down(dev);
+    usb_kill_anchored_urbs(&dev->async_anchor);
+    // a running stream or listener ends here, its reader or writer gets the error
+    usb_kill_anchored_urbs(&dev->stream_in.anchor);
+    usb_kill_anchored_urbs(&dev->stream_out.anchor);
+    usb_kill_anchored_urbs(&dev->stream_iso.anchor);
+    usb_kill_urb(dev->endpoints.interrupt.in.urb);
     return ACCESIO_SUCCESS;
 }
 
@@ -1224,8 +3001,13 @@ static int accesio_usb_resume(struct usb_interface* intf)
 static int accesio_usb_pre_reset(struct usb_interface* intf)
 {
     accesio_usb_device_info* dev = usb_get_intfdata(intf);
-    mutex_lock(&dev->io_mutex);
+    down_write(&dev->io_rwsem);
     accesio_usb_draw_down(dev);
+    usb_kill_anchored_urbs(&dev->async_anchor);
+    usb_kill_anchored_urbs(&dev->stream_in.anchor);
+    usb_kill_anchored_urbs(&dev->stream_out.anchor);
+    usb_kill_anchored_urbs(&dev->stream_iso.anchor);
+    usb_kill_urb(dev->endpoints.interrupt.in.urb);
     return ACCESIO_SUCCESS;
 }
 
@@ -1234,7 +3016,7 @@ static int accesio_usb_post_reset(struct usb_interface* intf)
     accesio_usb_device_info* dev = usb_get_intfdata(intf);
     /* we are sure no URBs are active - no locking needed */
     dev->errors = -EPIPE;
-    mutex_unlock(&dev->io_mutex);
+    up_write(&dev->io_rwsem);
     return ACCESIO_SUCCESS;
 }
 
@@ -33,7 +33,7 @@ allocations > PAGE_SIZE and the number of packets in a page
 is an integer 512 is the largest possible packet on EHCI */
 #define ACCESIO_USB_MAX_XFR (PAGE_SIZE - 512)
 
-// arbitrarily chosen (writes in flight)
+// arbitrarily chosen (writes in flight), the initial depth of the write pool
 #define ACCESIO_USB_WIF	8
 
 #define ACCESIO_USB_ANCHOR_TIMEOUT 1000
@@ -50,4 +50,10 @@ is an integer 512 is the largest possible packet on EHCI */
 #define ACCESIO_USB_WRITE_RETRY 5
 #define ACCESIO_USB_RAM_REG 0xE600
 
+/* Firmware RAM image size; on the FX2 on-chip RAM ends at ACCESIO_USB_FW_EXTERNAL
+and a single firmware write never spans it. */
+#define ACCESIO_USB_FW_SIZE 0x4000
+#define ACCESIO_USB_FW_EXTERNAL 0x2000
+#define ACCESIO_USB_FW_CHUNK 4096 // bytes per control transfer
+
 #endif // ACCESIO_LINUX_DECLARATIONS_H
\ No newline at end of file
@@ -35,6 +35,7 @@ static char* accesio_usb_get_devnode(struct device* dev, umode_t* mode);
 static int accesio_usb_probe(struct usb_interface* interface, const struct usb_device_id* id);
 static void accesio_usb_disconnect(struct usb_interface* interface);
 static void accesio_usb_draw_down(accesio_usb_device_info* dev);
+static void accesio_usb_coalesce_push(accesio_usb_device_info* dev);
 #if defined(CONFIG_PM) || defined(ACCESIO_USB_AUTOSUSPEND)
     static int accesio_usb_suspend(struct usb_interface* intf, pm_message_t message);
     static int accesio_usb_resume(struct usb_interface* intf);
@@ -43,6 +44,7 @@ static int accesio_usb_pre_reset(struct usb_interface* intf);
 static int accesio_usb_post_reset(struct usb_interface* intf);
 static void accesio_usb_draw_down(accesio_usb_device_info* dev);
 static void accesio_usb_delete(struct kref* kref);
+static enum hrtimer_restart accesio_usb_sg_timeout(struct hrtimer* timer);
 static int accesio_usb_open(struct inode* inode, struct file* file);
 static int accesio_usb_release(struct inode* inode, struct file* file);
 static int accesio_usb_flush(struct file* file, fl_owner_t id);
@@ -50,8 +52,21 @@ static void accesio_usb_read_bulk_callback(struct urb* urb);
 static int accesio_usb_do_read_io(accesio_usb_device_info* dev, size_t count);
 static ssize_t accesio_usb_read(struct file* file, char* buffer, size_t count, loff_t* ppos);
 static void accesio_usb_write_bulk_callback(struct urb* urb);
+static void accesio_usb_stream_in_callback(struct urb* urb);
+static void accesio_usb_stream_out_callback(struct urb* urb);
+static void accesio_usb_stream_iso_callback(struct urb* urb);
+static void accesio_usb_interrupt_callback(struct urb* urb);
 static ssize_t accesio_usb_write(struct file* file, const char* user_buffer, size_t count, loff_t* ppos);
+static enum hrtimer_restart accesio_usb_coalesce_timeout(struct hrtimer* timer);
+static void accesio_usb_coalesce_work(struct work_struct* work);
+#if LINUX_VERSION_CODE < KERNEL_VERSION(3,1,0)
+static int accesio_usb_fsync(struct file* filp, int datasync);
+#else
+static int accesio_usb_fsync(struct file* filp, loff_t start, loff_t end, int datasync);
+#endif
 static loff_t accesio_usb_seek(struct file* filp, loff_t off, int origin);
+static unsigned int accesio_usb_poll(struct file* filp, poll_table* wait);
+static int accesio_usb_mmap(struct file* filp, struct vm_area_struct* vma);
 #if LINUX_VERSION_CODE < KERNEL_VERSION(2,6,39)
 static int accesio_usb_ioctl(struct inode* inode, struct file* filp, unsigned int cmd, unsigned long arg);
 #else 
@@ -80,7 +95,10 @@ static const struct file_operations accesio_usb_file_ops = {
     .open = accesio_usb_open,
     .release = accesio_usb_release,
     .flush = accesio_usb_flush,
+    .fsync = accesio_usb_fsync,
     .llseek = accesio_usb_seek,
+    .poll = accesio_usb_poll,
+    .mmap = accesio_usb_mmap,
 #if LINUX_VERSION_CODE < KERNEL_VERSION(2,6,39)
     .ioctl          = accesio_usb_ioctl,
 #else
@@ -29,6 +29,13 @@
 
 // internal driver structures
 
+typedef struct accesio_usb_bounce {
+    void* buffer;           // DMA-capable copy of the data of a synchronous transfer
+    size_t size;            // allocated size, grows on demand
+    uint64_t reuses;        // transfers that fit the buffer
+    uint64_t grows;         // allocations, the first one at probe
+} accesio_usb_bounce;
+
 typedef struct accesio_usb_endpoint_info {
     unsigned char address;    // endpoint address
     unsigned char* buffer;  // i/o buffer
@@ -36,6 +43,13 @@ typedef struct accesio_usb_endpoint_info {
     size_t filled;          // bytes in buffer
     size_t copied;          // already copied to user space
     struct urb* urb;        // urb of the endpoint
+    uint64_t completed_ns;  // ktime_get_ns() when urb last completed
+    unsigned char interval; // bInterval, for interrupt and isochronous endpoints
+    accesio_usb_bounce bounce; // synchronous transfers, guarded by lock
+    struct mutex lock;      // serializes the synchronous transfers in this direction
+    struct hrtimer sg_timer;            // cancels a scatter-gather transfer that timed out
+    struct usb_sg_request* sg_request;  // the scatter-gather transfer in progress, guarded by lock
+    bool sg_timed_out;
 } accesio_usb_endpoint_info;
 
 typedef struct accesio_usb_endpoint {
@@ -50,20 +64,121 @@ typedef struct accesio_usb_endpoints {
     accesio_usb_endpoint isochronous; // future devices
 } accesio_usb_endpoints;
 
+typedef struct accesio_usb_async {
+    struct list_head list;           // on async_pending, then async_done
+    struct urb* urb;
+    struct usb_ctrlrequest setup;
+    struct accesio_usb_device_info* dev;
+    struct file* owner;              // the file that submitted it, the only one that reaps it
+    bool killed;                     // being killed by its file's flush
+    accesio_usb_async_request request; // as submitted, completed in place
+} accesio_usb_async;
+
+typedef struct accesio_usb_clock {
+    uint64_t offset[ACCESIO_USB_CLOCK_POINTS]; // stream offset at each completion
+    uint64_t ns[ACCESIO_USB_CLOCK_POINTS];     // and its time
+    uint32_t count;
+    uint32_t next;
+} accesio_usb_clock;
+
+typedef struct accesio_usb_stream {
+    struct usb_anchor anchor;        // the stream's URBs, apart from submitted
+    struct urb* urbs[ACCESIO_USB_STREAM_URBS_MAX];
+    struct mutex lock;               // serializes start/stop
+    struct mutex io_lock;            // one reader or writer of the ring at a time
+    spinlock_t urb_lock;             // serializes the completions, guards idle
+    wait_queue_head_t wait;          // readers, writers and pollers
+    struct file* owner;              // the file that started the stream, released with it
+    accesio_usb_stream_control* control; // indices, the first page of the mapping
+    uint8_t* ring;                   // the page after control
+    uint32_t ring_size;              // power of two
+    uint32_t head;                   // bytes produced, free running, mirrored to control
+    atomic_t mapped;                 // the application's mappings of control and ring
+    uint32_t urb_count;
+    uint32_t urb_size;
+    struct urb* idle[ACCESIO_USB_STREAM_URBS_MAX]; // output URBs waiting for data
+    uint32_t idle_count;
+    uint32_t low_water;              // output, writers wake at or below this fill
+    uint64_t period_ns;              // isochronous, the time between packets
+    uint32_t sequence;               // isochronous, packets received
+    uint8_t altsetting;              // isochronous, selected while streaming
+    DECLARE_KFIFO_PTR(stamps, accesio_usb_stream_timestamp); // bulk-in, one per completion
+    uint64_t stamps_dropped;
+    accesio_usb_clock clock;         // latest completions, for the rate estimate
+    bool running;
+    int error;                       // the error that stopped the stream
+    uint64_t bytes;
+    uint64_t overruns;
+    uint64_t underruns;
+    uint64_t errors;
+    uint64_t urbs_done;
+} accesio_usb_stream;
+
+typedef struct accesio_usb_write_urb {
+    struct urb* urb;                 // with an ACCESIO_USB_MAX_XFR coherent buffer
+    struct accesio_usb_device_info* dev;
+} accesio_usb_write_urb;
+
+typedef struct accesio_usb_write_pool {
+    accesio_usb_write_urb* entries;
+    accesio_usb_write_urb** free;    // stack of the entries not in flight
+    uint32_t depth;                  // limit_sem counts the free entries
+    uint32_t free_count;
+    spinlock_t lock;                 // guards free against the completions
+    struct mutex resize_lock;
+    uint64_t writes;
+    uint64_t exhausted;
+} accesio_usb_write_pool;
+
+typedef struct accesio_usb_coalesce {
+    struct mutex lock;               // serializes the merging writers and the push
+    struct hrtimer timer;            // pushes a partly filled URB after delay_us
+    struct work_struct work;         // the timer's push, it needs the lock
+    accesio_usb_write_urb* entry;    // being filled, holds a limit_sem count
+    uint32_t length;                 // bytes in entry
+    uint32_t size;                   // writes merge up to this, 0 is off
+    uint32_t delay_us;
+} accesio_usb_coalesce;
+
+typedef struct accesio_usb_interrupt {
+    struct mutex lock;               // serializes start/stop/read
+    spinlock_t queue_lock;           // guards reports against the completion
+    wait_queue_head_t wait;          // pollers waiting on reports
+    struct file* owner;              // the file that started the listener, stopped with it
+    DECLARE_KFIFO_PTR(reports, accesio_usb_interrupt_report);
+    bool running;
+    int error;                       // the error that stopped the listener
+    uint32_t sequence;
+    uint64_t dropped;
+} accesio_usb_interrupt;
+
 typedef struct accesio_usb_device_info {
     struct usb_device* udev;         /* the usb kernel device for this device */
     struct usb_interface* interface; /* the interface for this device */
     struct semaphore limit_sem;      /* limiting the number of writes in progress */
+    accesio_usb_write_pool write_pool; /* the URBs of write(), one per limit_sem count */
+    accesio_usb_coalesce coalesce;   /* small writes merged into one URB */
     struct usb_anchor submitted;     /* in case we need to retract our submissions */
     accesio_usb_endpoints endpoints;
     int errors;                      /* the last request tanked */
     bool ongoing_read;               /* a read is going on */
     spinlock_t err_lock;             /* lock for errors */
     struct kref kref;                /* kernel reference object */
-    struct mutex io_mutex;           /* synchronize I/O with disconnect */
+    struct rw_semaphore io_rwsem;    /* held shared by I/O, exclusive to synchronize with disconnect */
     wait_queue_head_t io_wait;       /* to wait for an ongoing read */
     
-    bool ctrl_msg;                    /* true if currently sending a urb */
+    struct usb_anchor async_anchor;   /* asynchronous transfers, apart from submitted */
+    struct list_head async_pending;   /* asynchronous transfers in flight */
+    struct list_head async_done;      /* completed, waiting to be reaped */
+    spinlock_t async_lock;            /* guards the async lists against the completions */
+    wait_queue_head_t async_wait;     /* reapers and pollers */
+    uint32_t async_count;             /* in flight plus not reaped */
+    uint64_t async_tag;               /* last tag handed out */
+    accesio_usb_stream stream_in;     /* continuous bulk-in stream */
+    accesio_usb_stream stream_out;    /* continuous bulk-out stream */
+    accesio_usb_stream stream_iso;    /* isochronous-in stream of packet records */
+    accesio_usb_interrupt interrupt;  /* interrupt-IN listener, on endpoints.interrupt.in.urb */
+    atomic_t ctrl_msg;                /* bulk-out and control-out sends under way */
     uint32_t device_index;            /* the device index of the dev tree */
     uint32_t product_id;              /* the devices product id */
 } accesio_usb_device_info;